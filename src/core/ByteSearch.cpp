@@ -0,0 +1,507 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ByteSearch.h"
+#include "CaseFolding.h"
+
+#include <cstring>
+
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define PLP_X86 1
+#include <emmintrin.h>
+#include <immintrin.h>
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+#if defined(PLP_X86) && (defined(__GNUC__) || defined(__clang__))
+#define PLP_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define PLP_TARGET_AVX2
+#endif
+
+namespace PLP {
+    namespace {
+        unsigned int bitScanForward(unsigned int mask) {
+#ifdef _MSC_VER
+            unsigned long index;
+            _BitScanForward(&index, mask);
+            return index;
+#else
+            return __builtin_ctz(mask);
+#endif
+        }
+
+        SimdLevel detectSimdLevel() {
+#ifdef PLP_X86
+#ifdef _MSC_VER
+            int info[4];
+            __cpuid(info, 0);
+            const int maxLeaf = info[0];
+
+            __cpuid(info, 1);
+            const bool sse2 = (info[3] & (1 << 26)) != 0;
+            const bool osxsave = (info[2] & (1 << 27)) != 0;
+            const bool avx = (info[2] & (1 << 28)) != 0;
+
+            bool avx2 = false;
+            if (maxLeaf >= 7 && osxsave && avx && (_xgetbv(0) & 0x6) == 0x6) { // OS saves the YMM registers
+                __cpuidex(info, 7, 0);
+                avx2 = (info[1] & (1 << 5)) != 0;
+            }
+
+            if (avx2) {
+                return SIMD_AVX2;
+            }
+            return sse2 ? SIMD_SSE2 : SIMD_NONE;
+#else
+            __builtin_cpu_init();
+            if (__builtin_cpu_supports("avx2")) {
+                return SIMD_AVX2;
+            }
+            return __builtin_cpu_supports("sse2") ? SIMD_SSE2 : SIMD_NONE;
+#endif
+#else
+            return SIMD_NONE;
+#endif
+        }
+
+        const char* findByteScalar(const char* begin, const char* end, char byte) {
+            const void* pos = memchr(begin, byte, end - begin);
+            return pos ? static_cast<const char*>(pos) : end;
+        }
+
+#ifdef PLP_X86
+        const char* findByteSse2(const char* begin, const char* end, char byte) {
+            const __m128i needle = _mm_set1_epi8(byte);
+            const char* pos = begin;
+            for (; end - pos >= 64; pos += 64) { // four vectors per iteration, one branch
+                const __m128i a = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)), needle);
+                const __m128i b = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + 16)), needle);
+                const __m128i c = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + 32)), needle);
+                const __m128i d = _mm_cmpeq_epi8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + 48)), needle);
+                if (_mm_movemask_epi8(_mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d))) != 0) {
+                    break;
+                }
+            }
+
+            for (; end - pos >= 16; pos += 16) {
+                const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+                const unsigned int mask = (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(block, needle));
+                if (mask != 0) {
+                    return pos + bitScanForward(mask);
+                }
+            }
+
+            return findByteScalar(pos, end, byte);
+        }
+
+        PLP_TARGET_AVX2 const char* findByteAvx2(const char* begin, const char* end, char byte) {
+            const __m256i needle = _mm256_set1_epi8(byte);
+            const char* pos = begin;
+            for (; end - pos >= 64; pos += 64) {
+                const __m256i a = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos)), needle);
+                const __m256i b = _mm256_cmpeq_epi8(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + 32)), needle);
+                if (_mm256_movemask_epi8(_mm256_or_si256(a, b)) != 0) {
+                    break;
+                }
+            }
+
+            for (; end - pos >= 32; pos += 32) {
+                const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+                const unsigned int mask = (unsigned int)_mm256_movemask_epi8(_mm256_cmpeq_epi8(block, needle));
+                if (mask != 0) {
+                    return pos + bitScanForward(mask);
+                }
+            }
+
+            return findByteSse2(pos, end, byte);
+        }
+
+        unsigned long long countByteSse2(const char* begin, const char* end, char byte) {
+            const __m128i needle = _mm_set1_epi8(byte);
+            const __m128i zero = _mm_setzero_si128();
+            unsigned long long count = 0;
+            const char* pos = begin;
+            while (end - pos >= 16) {
+                // every lane of the 8 bit accumulator counts matches as -1, summed before it can overflow
+                __m128i acc = _mm_setzero_si128();
+                for (int i = 0; i < 255 && end - pos >= 16; i++, pos += 16) {
+                    const __m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+                    acc = _mm_add_epi8(acc, _mm_cmpeq_epi8(block, needle));
+                }
+                const __m128i sum = _mm_sad_epu8(_mm_sub_epi8(zero, acc), zero);
+                count += (unsigned int)_mm_cvtsi128_si32(sum) + (unsigned int)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+            }
+
+            for (; pos < end; pos++) {
+                count += *pos == byte;
+            }
+            return count;
+        }
+
+        PLP_TARGET_AVX2 unsigned long long countByteAvx2(const char* begin, const char* end, char byte) {
+            const __m256i needle = _mm256_set1_epi8(byte);
+            const __m256i zero = _mm256_setzero_si256();
+            unsigned long long count = 0;
+            const char* pos = begin;
+            while (end - pos >= 32) {
+                __m256i acc = _mm256_setzero_si256();
+                for (int i = 0; i < 255 && end - pos >= 32; i++, pos += 32) {
+                    const __m256i block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+                    acc = _mm256_add_epi8(acc, _mm256_cmpeq_epi8(block, needle));
+                }
+                const __m256i sums = _mm256_sad_epu8(_mm256_sub_epi8(zero, acc), zero);
+                const __m128i sum = _mm_add_epi64(_mm256_castsi256_si128(sums), _mm256_extracti128_si256(sums, 1));
+                count += (unsigned int)_mm_cvtsi128_si32(sum) + (unsigned int)_mm_cvtsi128_si32(_mm_srli_si128(sum, 8));
+            }
+
+            return count + countByteSse2(pos, end, byte);
+        }
+#endif
+
+        const char* findSubstringScalar(const char* begin, const char* end, const char* needle, unsigned int needleSize) {
+            const char* lastCandidate = end - needleSize;
+            const char* pos = begin;
+            while (pos <= lastCandidate) {
+                pos = findByteScalar(pos, lastCandidate + 1, needle[0]);
+                if (pos > lastCandidate) {
+                    break;
+                }
+                if (memcmp(pos + 1, needle + 1, needleSize - 1) == 0) {
+                    return pos;
+                }
+                pos++;
+            }
+            return end;
+        }
+
+#ifdef PLP_X86
+        const char* findSubstringSse2(const char* begin, const char* end, const char* needle, unsigned int needleSize) {
+            const __m128i first = _mm_set1_epi8(needle[0]);
+            const __m128i last = _mm_set1_epi8(needle[needleSize - 1]);
+            const char* pos = begin;
+            for (; end - pos >= (long long)needleSize - 1 + 16; pos += 16) {
+                const __m128i blockFirst = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos));
+                const __m128i blockLast = _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + needleSize - 1));
+                unsigned int mask = (unsigned int)_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))
+                );
+                while (mask != 0) {
+                    const unsigned int bit = bitScanForward(mask);
+                    if (memcmp(pos + bit + 1, needle + 1, needleSize - 2) == 0) {
+                        return pos + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findSubstringScalar(pos, end, needle, needleSize);
+        }
+
+        PLP_TARGET_AVX2 const char* findSubstringAvx2(const char* begin, const char* end, const char* needle, unsigned int needleSize) {
+            const __m256i first = _mm256_set1_epi8(needle[0]);
+            const __m256i last = _mm256_set1_epi8(needle[needleSize - 1]);
+            const char* pos = begin;
+            for (; end - pos >= (long long)needleSize - 1 + 32; pos += 32) {
+                const __m256i blockFirst = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos));
+                const __m256i blockLast = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + needleSize - 1));
+                unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))
+                );
+                while (mask != 0) {
+                    const unsigned int bit = bitScanForward(mask);
+                    if (memcmp(pos + bit + 1, needle + 1, needleSize - 2) == 0) {
+                        return pos + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findSubstringSse2(pos, end, needle, needleSize);
+        }
+#endif
+
+        const char* findSubstringIgnoreCaseScalar(const char* begin, const char* end, const char* foldedNeedle, unsigned int needleSize) {
+            for (const char* pos = begin; end - pos >= (long long)needleSize; pos++) {
+                if (equalsIgnoreCaseAscii(pos, foldedNeedle, needleSize)) {
+                    return pos;
+                }
+            }
+            return end;
+        }
+
+#ifdef PLP_X86
+        // lowercases the ASCII letters of 16 bytes. Bytes above 0x7F compare as negative and are left alone
+        __m128i foldCaseSse2(__m128i block) {
+            const __m128i isUpper = _mm_and_si128(
+                _mm_cmpgt_epi8(block, _mm_set1_epi8('A' - 1)),
+                _mm_cmpgt_epi8(_mm_set1_epi8('Z' + 1), block)
+            );
+            return _mm_or_si128(block, _mm_and_si128(isUpper, _mm_set1_epi8(0x20)));
+        }
+
+        PLP_TARGET_AVX2 __m256i foldCaseAvx2(__m256i block) {
+            const __m256i isUpper = _mm256_and_si256(
+                _mm256_cmpgt_epi8(block, _mm256_set1_epi8('A' - 1)),
+                _mm256_cmpgt_epi8(_mm256_set1_epi8('Z' + 1), block)
+            );
+            return _mm256_or_si256(block, _mm256_and_si256(isUpper, _mm256_set1_epi8(0x20)));
+        }
+
+        const char* findSubstringIgnoreCaseSse2(const char* begin, const char* end, const char* foldedNeedle, unsigned int needleSize) {
+            const __m128i first = _mm_set1_epi8(foldedNeedle[0]);
+            const __m128i last = _mm_set1_epi8(foldedNeedle[needleSize - 1]);
+            const char* pos = begin;
+            for (; end - pos >= (long long)needleSize - 1 + 16; pos += 16) {
+                const __m128i blockFirst = foldCaseSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)));
+                const __m128i blockLast = foldCaseSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos + needleSize - 1)));
+                unsigned int mask = (unsigned int)_mm_movemask_epi8(
+                    _mm_and_si128(_mm_cmpeq_epi8(blockFirst, first), _mm_cmpeq_epi8(blockLast, last))
+                );
+                while (mask != 0) {
+                    const unsigned int bit = bitScanForward(mask);
+                    if (equalsIgnoreCaseAscii(pos + bit + 1, foldedNeedle + 1, needleSize - 2)) {
+                        return pos + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findSubstringIgnoreCaseScalar(pos, end, foldedNeedle, needleSize);
+        }
+
+        PLP_TARGET_AVX2 const char* findSubstringIgnoreCaseAvx2(const char* begin, const char* end, const char* foldedNeedle, unsigned int needleSize) {
+            const __m256i first = _mm256_set1_epi8(foldedNeedle[0]);
+            const __m256i last = _mm256_set1_epi8(foldedNeedle[needleSize - 1]);
+            const char* pos = begin;
+            for (; end - pos >= (long long)needleSize - 1 + 32; pos += 32) {
+                const __m256i blockFirst = foldCaseAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos)));
+                const __m256i blockLast = foldCaseAvx2(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos + needleSize - 1)));
+                unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+                    _mm256_and_si256(_mm256_cmpeq_epi8(blockFirst, first), _mm256_cmpeq_epi8(blockLast, last))
+                );
+                while (mask != 0) {
+                    const unsigned int bit = bitScanForward(mask);
+                    if (equalsIgnoreCaseAscii(pos + bit + 1, foldedNeedle + 1, needleSize - 2)) {
+                        return pos + bit;
+                    }
+                    mask &= mask - 1;
+                }
+            }
+            return findSubstringIgnoreCaseSse2(pos, end, foldedNeedle, needleSize);
+        }
+
+        bool isAsciiSse2(const char* begin, const char* end) {
+            const char* pos = begin;
+            __m128i acc = _mm_setzero_si128();
+            for (; end - pos >= 16; pos += 16) {
+                acc = _mm_or_si128(acc, _mm_loadu_si128(reinterpret_cast<const __m128i*>(pos)));
+            }
+            if (_mm_movemask_epi8(acc) != 0) {
+                return false;
+            }
+
+            for (; pos < end; pos++) {
+                if ((unsigned char)*pos >= 0x80) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // bit i is set if byte i of the block is whitespace, see isSpaceByte
+        unsigned int spaceMaskSse2(__m128i block) {
+            const __m128i offset = _mm_sub_epi8(block, _mm_set1_epi8('\t'));
+            const __m128i isControlSpace = _mm_cmpeq_epi8(_mm_min_epu8(offset, _mm_set1_epi8('\r' - '\t')), offset);
+            return (unsigned int)_mm_movemask_epi8(_mm_or_si128(isControlSpace, _mm_cmpeq_epi8(block, _mm_set1_epi8(' '))));
+        }
+
+        // flip is 0 to find whitespace and 0xFFFF to find anything else
+        const char* findSpaceClassSse2(const char* begin, const char* end, unsigned int flip) {
+            const char* pos = begin;
+            for (; end - pos >= 16; pos += 16) {
+                const unsigned int mask = spaceMaskSse2(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) ^ flip;
+                if (mask != 0) {
+                    return pos + bitScanForward(mask);
+                }
+            }
+            for (; pos < end; pos++) {
+                if (isSpaceByte(*pos) == (flip == 0)) {
+                    return pos;
+                }
+            }
+            return end;
+        }
+#endif
+
+        const char* findSpaceClassScalar(const char* begin, const char* end, bool space) {
+            for (const char* pos = begin; pos < end; pos++) {
+                if (isSpaceByte(*pos) == space) {
+                    return pos;
+                }
+            }
+            return end;
+        }
+
+        unsigned long long countByteScalar(const char* begin, const char* end, char byte) {
+            unsigned long long count = 0;
+            for (const char* pos = begin; pos < end; pos++) {
+                count += *pos == byte;
+            }
+            return count;
+        }
+
+        typedef const char* (*FindByteFunc)(const char* begin, const char* end, char byte);
+
+        FindByteFunc selectFindByte() {
+#ifdef PLP_X86
+            switch (getSimdLevel()) {
+            case SIMD_AVX2: return findByteAvx2;
+            case SIMD_SSE2: return findByteSse2;
+            default: break;
+            }
+#endif
+            return findByteScalar;
+        }
+
+        typedef const char* (*FindSubstringFunc)(const char* begin, const char* end, const char* needle, unsigned int needleSize);
+
+        FindSubstringFunc selectFindSubstring() {
+#ifdef PLP_X86
+            switch (getSimdLevel()) {
+            case SIMD_AVX2: return findSubstringAvx2;
+            case SIMD_SSE2: return findSubstringSse2;
+            default: break;
+            }
+#endif
+            return findSubstringScalar;
+        }
+
+        FindSubstringFunc selectFindSubstringIgnoreCase() {
+#ifdef PLP_X86
+            switch (getSimdLevel()) {
+            case SIMD_AVX2: return findSubstringIgnoreCaseAvx2;
+            case SIMD_SSE2: return findSubstringIgnoreCaseSse2;
+            default: break;
+            }
+#endif
+            return findSubstringIgnoreCaseScalar;
+        }
+
+        typedef unsigned long long (*CountByteFunc)(const char* begin, const char* end, char byte);
+
+        CountByteFunc selectCountByte() {
+#ifdef PLP_X86
+            switch (getSimdLevel()) {
+            case SIMD_AVX2: return countByteAvx2;
+            case SIMD_SSE2: return countByteSse2;
+            default: break;
+            }
+#endif
+            return countByteScalar;
+        }
+    }
+
+    SimdLevel getSimdLevel() {
+        static const SimdLevel level = detectSimdLevel();
+        return level;
+    }
+
+    const char* findByte(const char* begin, const char* end, char byte) {
+        static const FindByteFunc findByteImpl = selectFindByte();
+        if (begin >= end) {
+            return end;
+        }
+        return findByteImpl(begin, end, byte);
+    }
+
+    unsigned long long countByte(const char* begin, const char* end, char byte) {
+        static const CountByteFunc countByteImpl = selectCountByte();
+        if (begin >= end) {
+            return 0;
+        }
+        return countByteImpl(begin, end, byte);
+    }
+
+    const char* findSubstring(const char* begin, const char* end, const char* needle, unsigned int needleSize) {
+        static const FindSubstringFunc findSubstringImpl = selectFindSubstring();
+        if (needleSize == 0) {
+            return begin;
+        }
+        if (begin >= end || (unsigned long long)(end - begin) < needleSize) {
+            return end;
+        }
+        if (needleSize == 1) {
+            return findByte(begin, end, needle[0]);
+        }
+        return findSubstringImpl(begin, end, needle, needleSize);
+    }
+
+    const char* findSubstringIgnoreCase(const char* begin, const char* end, const char* foldedNeedle, unsigned int needleSize) {
+        static const FindSubstringFunc findSubstringIgnoreCaseImpl = selectFindSubstringIgnoreCase();
+        if (needleSize == 0) {
+            return begin;
+        }
+        if (begin >= end || (unsigned long long)(end - begin) < needleSize) {
+            return end;
+        }
+        if (needleSize == 1) {
+            return findSubstringIgnoreCaseScalar(begin, end, foldedNeedle, needleSize);
+        }
+        return findSubstringIgnoreCaseImpl(begin, end, foldedNeedle, needleSize);
+    }
+
+    bool isAscii(const char* begin, const char* end) {
+#ifdef PLP_X86
+        if (getSimdLevel() != SIMD_NONE) {
+            return isAsciiSse2(begin, end);
+        }
+#endif
+        for (const char* pos = begin; pos < end; pos++) {
+            if ((unsigned char)*pos >= 0x80) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const char* findSpace(const char* begin, const char* end) {
+#ifdef PLP_X86
+        if (getSimdLevel() != SIMD_NONE) {
+            return findSpaceClassSse2(begin, end, 0);
+        }
+#endif
+        return findSpaceClassScalar(begin, end, true);
+    }
+
+    const char* findNonSpace(const char* begin, const char* end) {
+#ifdef PLP_X86
+        if (getSimdLevel() != SIMD_NONE) {
+            return findSpaceClassSse2(begin, end, 0xFFFF);
+        }
+#endif
+        return findSpaceClassScalar(begin, end, false);
+    }
+
+    const char* findLastByte(const char* begin, const char* end, char byte) {
+        for (const char* pos = end; pos > begin; pos--) {
+            if (*(pos - 1) == byte) {
+                return pos - 1;
+            }
+        }
+        return end;
+    }
+}
\ No newline at end of file
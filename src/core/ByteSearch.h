@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace PLP {
+    enum SimdLevel {
+        SIMD_NONE = 0,
+        SIMD_SSE2 = 1,
+        SIMD_AVX2 = 2
+    };
+
+    // Highest instruction set supported by both the build target and the CPU, detected once at startup
+    SimdLevel getSimdLevel();
+
+    // Returns the first occurrence of byte in [begin, end) or end if there is none.
+    // Uses the widest vector kernel available on the running CPU
+    const char* findByte(const char* begin, const char* end, char byte);
+
+    // Returns the number of occurrences of byte in [begin, end)
+    unsigned long long countByte(const char* begin, const char* end, char byte);
+
+    // Returns a pointer to the last occurrence of byte in [begin, end) or end if not found.
+    // Meant for short distances such as the start of the current line, so it isn't vectorized
+    const char* findLastByte(const char* begin, const char* end, char byte);
+
+    // Returns the first occurrence of needle in [begin, end) or end if there is none. Candidates are filtered
+    // by comparing the first and the last byte of the needle a vector at a time, and verified with memcmp
+    const char* findSubstring(const char* begin, const char* end, const char* needle, unsigned int needleSize);
+
+    // Same as findSubstring, but ASCII letters in [begin, end) are lowercased before comparing. foldedNeedle has to be lowercase
+    const char* findSubstringIgnoreCase(const char* begin, const char* end, const char* foldedNeedle, unsigned int needleSize);
+
+    // Returns true if [begin, end) only contains 7-bit ASCII bytes
+    bool isAscii(const char* begin, const char* end);
+
+    // True for the bytes std::isspace accepts in the "C" locale: space, \t, \n, \v, \f and \r
+    inline bool isSpaceByte(char byte) {
+        return byte == ' ' || (unsigned char)(byte - '\t') <= '\r' - '\t';
+    }
+
+    // Returns the first whitespace byte in [begin, end) or end if there is none
+    const char* findSpace(const char* begin, const char* end);
+
+    // Returns the first byte in [begin, end) that isn't whitespace or end if there is none
+    const char* findNonSpace(const char* begin, const char* end);
+}
\ No newline at end of file
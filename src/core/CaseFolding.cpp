@@ -0,0 +1,129 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "CaseFolding.h"
+
+#include <cwctype>
+
+namespace PLP {
+    unsigned int foldCaseCodePoint(unsigned int codePoint) {
+        if (codePoint < 0x80) {
+            return (unsigned int)(unsigned char)foldCaseAscii((char)codePoint);
+        }
+
+        if (codePoint >= 0xC0 && codePoint <= 0xDE && codePoint != 0xD7) { // Latin-1
+            return codePoint + 0x20;
+        }
+
+        if (codePoint >= 0x100 && codePoint <= 0x17F) { // Latin Extended-A, upper and lower case alternate
+            if (codePoint == 0x130) {
+                return 'i';
+            }
+            if (codePoint == 0x178) {
+                return 0xFF;
+            }
+            if ((codePoint >= 0x139 && codePoint <= 0x148) || (codePoint >= 0x179 && codePoint <= 0x17E)) {
+                return (codePoint % 2 == 1) ? codePoint + 1 : codePoint;
+            }
+            if (codePoint == 0x131 || codePoint == 0x138 || codePoint == 0x149 || codePoint == 0x17F) {
+                return codePoint;
+            }
+            return (codePoint % 2 == 0) ? codePoint + 1 : codePoint;
+        }
+
+        if (codePoint >= 0x391 && codePoint <= 0x3A9 && codePoint != 0x3A2) { // Greek
+            return codePoint + 0x20;
+        }
+
+        if (codePoint >= 0x400 && codePoint <= 0x40F) { // Cyrillic
+            return codePoint + 0x50;
+        }
+        if (codePoint >= 0x410 && codePoint <= 0x42F) {
+            return codePoint + 0x20;
+        }
+
+        if (codePoint <= 0xFFFF || sizeof(wchar_t) > 2) {
+            return (unsigned int)std::towlower((wint_t)codePoint);
+        }
+        return codePoint;
+    }
+
+    void foldCaseUtf8(const char* data, unsigned int size, std::string& out) {
+        out.clear();
+
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        unsigned int pos = 0;
+        while (pos < size) {
+            const unsigned char lead = bytes[pos];
+            if (lead < 0x80) {
+                out.push_back(foldCaseAscii((char)lead));
+                pos++;
+                continue;
+            }
+
+            unsigned int length;
+            unsigned int codePoint;
+            if ((lead & 0xE0) == 0xC0) {
+                length = 2;
+                codePoint = lead & 0x1F;
+            } else if ((lead & 0xF0) == 0xE0) {
+                length = 3;
+                codePoint = lead & 0x0F;
+            } else if ((lead & 0xF8) == 0xF0) {
+                length = 4;
+                codePoint = lead & 0x07;
+            } else {
+                out.push_back((char)lead);
+                pos++;
+                continue;
+            }
+
+            bool valid = pos + length <= size;
+            for (unsigned int i = 1; valid && i < length; i++) {
+                if ((bytes[pos + i] & 0xC0) != 0x80) {
+                    valid = false;
+                } else {
+                    codePoint = (codePoint << 6) | (bytes[pos + i] & 0x3F);
+                }
+            }
+
+            if (!valid) {
+                out.push_back((char)lead);
+                pos++;
+                continue;
+            }
+
+            codePoint = foldCaseCodePoint(codePoint);
+            if (codePoint < 0x80) {
+                out.push_back((char)codePoint);
+            } else if (codePoint < 0x800) {
+                out.push_back((char)(0xC0 | (codePoint >> 6)));
+                out.push_back((char)(0x80 | (codePoint & 0x3F)));
+            } else if (codePoint < 0x10000) {
+                out.push_back((char)(0xE0 | (codePoint >> 12)));
+                out.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (codePoint & 0x3F)));
+            } else {
+                out.push_back((char)(0xF0 | (codePoint >> 18)));
+                out.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+                out.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+                out.push_back((char)(0x80 | (codePoint & 0x3F)));
+            }
+            pos += length;
+        }
+    }
+}
\ No newline at end of file
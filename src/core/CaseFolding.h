@@ -0,0 +1,43 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+
+namespace PLP {
+    static inline char foldCaseAscii(char c) {
+        return (c >= 'A' && c <= 'Z') ? (char)(c + ('a' - 'A')) : c;
+    }
+
+    // Compares size bytes of data against an already lowercased string, ignoring the case of ASCII letters in data
+    static inline bool equalsIgnoreCaseAscii(const char* data, const char* folded, unsigned int size) {
+        for (unsigned int i = 0; i < size; i++) {
+            if (foldCaseAscii(data[i]) != folded[i]) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    // Lowercases a Unicode code point. Covers Latin-1, Latin Extended-A, Greek and Cyrillic directly
+    unsigned int foldCaseCodePoint(unsigned int codePoint);
+
+    // Writes data to out with every character lowercased. ASCII bytes are folded directly, other UTF-8 sequences
+    // are decoded and folded per code point. Invalid sequences are copied unchanged
+    void foldCaseUtf8(const char* data, unsigned int size, std::string& out);
+}
\ No newline at end of file
@@ -17,22 +17,29 @@
 
 #include "CircularLineBuffer.h"
 
+#include <cstring>
+#include <algorithm>
+
 namespace PLP {
     CircularLineBuffer::CircularLineBuffer() {}
 
-    bool CircularLineBuffer::initialize(unsigned int lineSize, unsigned int numLines) {
-        if (lineSize == 0 || numLines == 0) {
+    bool CircularLineBuffer::initialize(unsigned int maxLineSize, unsigned int numLines) {
+        if (maxLineSize == 0 || numLines == 0) {
             return false;
         }
 
+        // every slot starts out as an empty line
         try {
-            for (unsigned int i = 0; i < numLines; i++) {
-                _lineBuffers.emplace_back(lineSize);
-            }
-            _lineNumFileOffset.resize(numLines);
+            _lines.resize(numLines);
+            _data.assign((size_t)numLines * 2 > MIN_DATA_SIZE ? (size_t)numLines * 2 : MIN_DATA_SIZE, 0);
         } catch (std::bad_alloc&) {
             return false;
         }
+        for (unsigned int i = 0; i < numLines; i++) {
+            _lines[i] = { 0, 0, i, 0 };
+        }
+        _dataEnd = numLines;
+        _maxLineSize = maxLineSize;
 
         return true;
     }
@@ -42,16 +49,53 @@ namespace PLP {
     }
 
     bool CircularLineBuffer::pushBack(unsigned long long lineNum, unsigned long long fileOffset, const char* data, unsigned int size) {
-        _lineNumFileOffset[_currPos] = { lineNum, fileOffset };
-        if (!_lineBuffers[_currPos].set(data, size)) {
+        if (size > _maxLineSize || !reserve((size_t)size + 1)) {
             return false;
         }
 
+        memcpy(_data.data() + _dataEnd, data, size);
+        _data[_dataEnd + size] = 0;
+        _lines[_currPos] = { lineNum, fileOffset, _dataEnd, size };
+        _dataEnd += (size_t)size + 1;
+
         if (_currPos == _startPos) {
-            _startPos = (_startPos + 1) % _lineBuffers.size();
+            _startPos = (_startPos + 1) % _lines.size();
         }
 
-        _currPos = (_currPos + 1) % _lineBuffers.size();
+        _currPos = (_currPos + 1) % _lines.size();
+        return true;
+    }
+
+    // Makes room for size bytes after the newest line. The line in _currPos is about to be replaced, so the data
+    // that is still needed starts at the next oldest line. It is moved to the front of the arena, which is grown
+    // first if the lines would take up more than half of it
+    bool CircularLineBuffer::reserve(size_t size) {
+        if (_dataEnd + size <= _data.size()) {
+            return true;
+        }
+
+        const unsigned int nextOldest = (_currPos + 1) % _lines.size();
+        const size_t liveStart = nextOldest == _currPos ? _dataEnd : _lines[nextOldest].dataOffset;
+        const size_t liveSize = _dataEnd - liveStart;
+
+        if ((liveSize + size) * 2 > _data.size()) {
+            try {
+                std::vector<char> data(std::max(_data.size() * 2, (liveSize + size) * 2));
+                memcpy(data.data(), _data.data() + liveStart, liveSize);
+                _data.swap(data);
+            } catch (std::bad_alloc&) {
+                return false;
+            }
+        } else {
+            memmove(_data.data(), _data.data() + liveStart, liveSize);
+        }
+
+        for (unsigned int i = 0; i < _lines.size(); i++) {
+            if (i != _currPos) {
+                _lines[i].dataOffset -= liveStart;
+            }
+        }
+        _dataEnd = liveSize;
         return true;
     }
 
@@ -69,19 +113,20 @@ namespace PLP {
         char*& data, 
         unsigned int& size
     ) {
-        if (linePos >= _lineBuffers.size()) {
+        if (linePos >= _lines.size()) {
             return false;
         }
 
-        const unsigned int index = (_startPos + linePos) % _lineBuffers.size();
-        lineNum = _lineNumFileOffset[index].first;
-        fileOffset = _lineNumFileOffset[index].second;
-        _lineBuffers[index].get(data, size);
+        const Line& line = _lines[(_startPos + linePos) % _lines.size()];
+        lineNum = line.lineNum;
+        fileOffset = line.fileOffset;
+        data = _data.data() + line.dataOffset;
+        size = line.size;
 
         return true;
     }
 
     unsigned int CircularLineBuffer::getSize() {
-        return (unsigned int)_lineBuffers.size();
+        return (unsigned int)_lines.size();
     }
 }
\ No newline at end of file
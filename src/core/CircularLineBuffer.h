@@ -17,21 +17,38 @@
 
 #pragma once
 
-#include "LineBuffer.h"
+#include <vector>
+#include <cstddef>
 
 namespace PLP {
+    // Fixed number of most recent lines. The bytes of the lines are stored back to back in one arena that holds
+    // about twice the bytes of the lines in the buffer, so memory follows the actual line sizes.
+    // Line data is null terminated and stays valid until the next pushBack
     class CircularLineBuffer {
     public:
         CircularLineBuffer();
-        bool initialize(unsigned int lineSize, unsigned int numLines);
+        bool initialize(unsigned int maxLineSize, unsigned int numLines);
         bool pushBack(const char* data, unsigned int size);
         bool pushBack(unsigned long long lineNum, unsigned long long fileOffset, const char* data, unsigned int size);
         bool get(unsigned int linePos, char*& data, unsigned int& size);
         bool get(unsigned int linePos, unsigned long long& lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size);
         unsigned int getSize();
     private:
-        std::vector<LineBuffer> _lineBuffers;
-        std::vector<std::pair<unsigned long long, unsigned long long>> _lineNumFileOffset;
+        struct Line {
+            unsigned long long lineNum;
+            unsigned long long fileOffset;
+            size_t dataOffset;
+            unsigned int size;
+        };
+
+        static const size_t MIN_DATA_SIZE = 64 * 1024;
+
+        bool reserve(size_t size);
+
+        std::vector<Line> _lines;
+        std::vector<char> _data;
+        size_t _dataEnd = 0;
+        unsigned int _maxLineSize = 0;
         unsigned int _startPos = 0;
         unsigned int _currPos = 0;
     };
@@ -0,0 +1,205 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ComparatorPlan.h"
+#include "TextComparator.h"
+
+namespace PLP {
+    bool ComparatorPlan::compile(TextComparator* root) {
+        _root = root;
+        _code.clear();
+        _sequences.clear();
+        _numMatches = 0;
+
+        try {
+            return compileNode(root);
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+    }
+
+    bool ComparatorPlan::match(const char* data, unsigned int size) {
+        const Instruction* code = _code.data();
+        const size_t numInstructions = _code.size();
+        bool result = false;
+
+        size_t pc = 0;
+        while (pc < numInstructions) {
+            const Instruction& instruction = code[pc];
+            switch (instruction.op) {
+            case OP_FIND_LITERAL:
+                result = static_cast<const LiteralSearcher*>(instruction.target)->find(data, size) != nullptr;
+                break;
+            case OP_EQUALS: {
+                const std::string& text = *static_cast<const std::string*>(instruction.target);
+                result = size == text.size() && memcmp(data, text.data(), size) == 0;
+                break;
+            }
+            case OP_FIND_ANY_LITERAL:
+                result = static_cast<const MultiLiteralSearcher*>(instruction.target)->containsAny(data, size);
+                break;
+            case OP_REGEX:
+                result = static_cast<RegexSearcher*>(instruction.target)->search(data, size);
+                break;
+            case OP_CALL:
+                result = static_cast<TextComparator*>(instruction.target)->match(data, size);
+                break;
+            case OP_CONSTANT:
+                result = instruction.value != 0;
+                break;
+            case OP_NOT:
+                result = !result;
+                break;
+            case OP_BEGIN_GROUP:
+                static_cast<ComparatorSequence*>(instruction.target)->recordEvaluation();
+                break;
+            case OP_RECORD:
+                static_cast<ComparatorSequence*>(instruction.target)->recordResult(instruction.value, result);
+                break;
+            case OP_JUMP_IF_TRUE:
+                if (result) {
+                    pc = instruction.value;
+                    continue;
+                }
+                break;
+            case OP_JUMP_IF_FALSE:
+                if (!result) {
+                    pc = instruction.value;
+                    continue;
+                }
+                break;
+            }
+            pc++;
+        }
+
+        _numMatches++;
+        if (_numMatches % REPLAN_INTERVAL == 0 && !_sequences.empty()) {
+            replan();
+        }
+        return result;
+    }
+
+    void ComparatorPlan::matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) {
+        if (_code.size() == 1 && _code[0].op == OP_CALL) {
+            static_cast<TextComparator*>(_code[0].target)->matchBatch(lines, count, selection);
+            return;
+        }
+
+        for (unsigned int i = 0; i < count; i++) {
+            if (selection[i]) {
+                selection[i] = match(lines[i].data, lines[i].size) ? 1 : 0;
+            }
+        }
+    }
+
+    bool ComparatorPlan::compileNode(TextComparator* node) {
+        ComparatorSequence* sequence = nullptr;
+        if (MatchAll* matchAll = dynamic_cast<MatchAll*>(node)) {
+            sequence = &matchAll->_sequence;
+        } else if (MatchAny* matchAny = dynamic_cast<MatchAny*>(node)) {
+            sequence = &matchAny->_sequence;
+        }
+
+        if (sequence) {
+            const std::vector<unsigned int>& order = sequence->getOrder();
+            if (order.empty()) {
+                emit(OP_CONSTANT, nullptr, sequence->getStopResult() ? 0 : 1);
+                return true;
+            }
+
+            _sequences.push_back(sequence);
+            emit(OP_BEGIN_GROUP, sequence);
+
+            // every child but the last jumps to the end of the group once it produces the stop result
+            std::vector<size_t> jumps;
+            for (size_t i = 0; i < order.size(); i++) {
+                if (!compileNode(sequence->getComparators()[order[i]].get())) {
+                    return false;
+                }
+                emit(OP_RECORD, sequence, order[i]);
+                if (i + 1 < order.size()) {
+                    jumps.push_back(_code.size());
+                    emit(sequence->getStopResult() ? OP_JUMP_IF_TRUE : OP_JUMP_IF_FALSE);
+                }
+            }
+            for (size_t jump : jumps) {
+                _code[jump].value = (unsigned int)_code.size();
+            }
+            return true;
+        }
+
+        if (MatchNot* matchNot = dynamic_cast<MatchNot*>(node)) {
+            if (!compileNode(matchNot->_comparator.get())) {
+                return false;
+            }
+            emit(OP_NOT);
+            return true;
+        }
+
+        if (MatchString* matchString = dynamic_cast<MatchString*>(node)) {
+            // case-insensitive matches fold non-ASCII lines first and go through OP_CALL
+            if (!matchString->_ignoreCase) {
+                if (matchString->_exact) {
+                    emit(OP_EQUALS, &matchString->_text);
+                } else {
+                    emit(OP_FIND_LITERAL, &matchString->_searcher);
+                }
+                return true;
+            }
+        } else if (MatchAnyString* matchAnyString = dynamic_cast<MatchAnyString*>(node)) {
+            emit(OP_FIND_ANY_LITERAL, &matchAnyString->_searcher);
+            return true;
+        } else if (MatchRegex* matchRegex = dynamic_cast<MatchRegex*>(node)) {
+            if (matchRegex->_useSearcher) {
+                emit(OP_REGEX, &matchRegex->_searcher);
+                return true;
+            }
+        }
+
+        emit(OP_CALL, node);
+        return true;
+    }
+
+    void ComparatorPlan::emit(Opcode op, void* target, unsigned int value) {
+        Instruction instruction;
+        instruction.op = op;
+        instruction.target = target;
+        instruction.value = value;
+        _code.push_back(instruction);
+    }
+
+    void ComparatorPlan::replan() {
+        for (ComparatorSequence* sequence : _sequences) {
+            sequence->rerank();
+        }
+
+        std::vector<Instruction> previousCode;
+        std::vector<ComparatorSequence*> previousSequences;
+        previousCode.swap(_code);
+        previousSequences.swap(_sequences);
+        try {
+            if (compileNode(_root)) {
+                return;
+            }
+        } catch (std::bad_alloc&) {
+        }
+
+        // keep running the previous order
+        _code.swap(previousCode);
+        _sequences.swap(previousSequences);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+namespace PLP {
+    class TextComparator;
+    class ComparatorSequence;
+    struct LineSpan;
+
+    // A comparator tree lowered into a flat instruction list. Literal, multi-literal and regex leaves call their searchers
+    // directly and MatchAll/MatchAny/MatchNot become jumps, so matching a line is one loop without virtual calls.
+    // Comparators that cannot be lowered (MatchSubstrings, MatchWords, MatchCustom, std::regex fallbacks) are called through
+    // TextComparator::match. Child results are still recorded in the MatchAll/MatchAny statistics, and the plan is
+    // re-ranked and recompiled periodically so the evaluation order keeps adapting.
+    // The tree has to be initialized and must outlive the plan
+    class ComparatorPlan {
+    public:
+        bool compile(TextComparator* root);
+        bool match(const char* data, unsigned int size);
+        // Same contract as TextComparator::matchBatch. A root that could not be lowered gets the whole batch
+        void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection);
+
+    private:
+        enum Opcode {
+            OP_FIND_LITERAL,
+            OP_EQUALS,
+            OP_FIND_ANY_LITERAL,
+            OP_REGEX,
+            OP_CALL,
+            OP_CONSTANT,
+            OP_NOT,
+            OP_BEGIN_GROUP,
+            OP_RECORD,
+            OP_JUMP_IF_TRUE,
+            OP_JUMP_IF_FALSE
+        };
+
+        struct Instruction {
+            Opcode op;
+            void* target = nullptr;
+            unsigned int value = 0; // jump destination, child index or constant
+        };
+
+        static const unsigned long long REPLAN_INTERVAL = 4096;
+
+        bool compileNode(TextComparator* node);
+        void emit(Opcode op, void* target = nullptr, unsigned int value = 0);
+        void replan();
+
+        TextComparator* _root = nullptr;
+        std::vector<Instruction> _code;
+        std::vector<ComparatorSequence*> _sequences;
+        unsigned long long _numMatches = 0;
+    };
+}
\ No newline at end of file
@@ -18,6 +18,8 @@
 #include "Core.h"
 
 #include "Thread.h"
+#include "ThreadPool.h"
+#include "ParallelScanner.h"
 #include "FileReader.h"
 #include "FileWriter.h"
 #include "IndexReader.h"
@@ -33,7 +35,12 @@
 #include "TextComparator.h"
 #include "Scanner.h"
 #include "GenFileTracker.h"
+#include "MemFileStore.h"
 #include "ProgressReporter.h"
+#include "ComparatorPlan.h"
+#include "LineBatch.h"
+#include "MatchCount.h"
+#include "SequenceMatcher.h"
 
 #include "lua.hpp"
 #include "LuaIntf/LuaIntf.h"
@@ -67,10 +74,14 @@ namespace PLP {
 
     Core::Core() {}
     Core::~Core() {
-        _fileOpThread->stopAndJoin();
+        // readers and writers owned by Lua wait for their pending page loads and writes, so they are released
+        // while the threads that run them are still up
         if (_state) {
             lua_close(_state);
         }
+        _fileOpThread->stopAndJoin();
+        _readAheadThread->stopAndJoin();
+        _workerPool->stopAndJoin();
 
         if (_cleanupGeneratedFiles) {
             for (auto& path : LC::GenFileTracker::getFiles()) {
@@ -78,6 +89,7 @@ namespace PLP {
             }
             LC::GenFileTracker::clear();
         }
+        MemFileStore::clear();
     }
 
     bool Core::initialize() {
@@ -90,12 +102,24 @@ namespace PLP {
         luaL_openlibs(_state);
         attachLuaBindings(_state);
 
-        _fileOpThread.reset(new Thread(1000000)); //1 ms sleep
+        _fileOpThread.reset(new Thread());
         if (!_fileOpThread->start()) {
             Logger::send(ERR, "Failed to start thread pool");
             return false;
         }
 
+        _readAheadThread.reset(new Thread());
+        if (!_readAheadThread->start()) {
+            Logger::send(ERR, "Failed to start read-ahead thread");
+            return false;
+        }
+
+        _workerPool.reset(new ThreadPool(std::thread::hardware_concurrency()));
+        if (!_workerPool->start()) {
+            Logger::send(ERR, "Failed to start worker threads");
+            return false;
+        }
+
         Logger::send(INFO, "Successfully initialized PLP core");
         return true;
     }
@@ -143,6 +167,14 @@ namespace PLP {
         _cancelled = true;
     }
 
+    void Core::setReadAheadDepth(unsigned int numPages) {
+        _readAheadDepth = numPages;
+    }
+
+    void Core::setSearchThreadCount(unsigned int numThreads) {
+        _searchThreadCount = numThreads;
+    }
+
     bool Core::attachLogOutput(const char* name, const std::function<void(int, const char*)>* func) {
         Logger::subscribe(name, *func);
         return true;
@@ -155,7 +187,8 @@ namespace PLP {
     FileReaderI* Core::createFileReader(
         const std::string& path,
         unsigned long long preferredBuffSizeBytes,
-        const std::function<void(int percent)>* progressUpdate
+        const std::function<void(int percent)>* progressUpdate,
+        PagedReaderType readerType
     ) {
         _cancelled = false;
 
@@ -166,7 +199,15 @@ namespace PLP {
         }
 
         std::unique_ptr<FileReader> fReader(new FileReader());
-        if (!fReader->initialize(string_to_wstring(path), preferredBuffSizeBytes, _cancelled, progressUpdateInt)) {
+        if (!fReader->initialize(
+            string_to_wstring(path), 
+            preferredBuffSizeBytes, 
+            readerType, 
+            _readAheadThread.get(), 
+            _readAheadDepth, 
+            _workerPool.get(),
+            _cancelled, 
+            progressUpdateInt)) {
             Logger::send(ERR, "Failed to create file reader");
             return nullptr;
         }
@@ -226,6 +267,40 @@ namespace PLP {
         return resSet.release();
     }
 
+    IndexWriterI* Core::createMemIndexWriter(
+        const std::string& path,
+        unsigned long long preferredBuffSizeBytes,
+        unsigned long long memoryBudgetBytes,
+        const FileReaderI* fReader,
+        bool overwriteIfExists
+    ) {
+        if (!fReader) {
+            Logger::send(ERR, "File reader is null");
+            return nullptr;
+        }
+
+        std::unique_ptr<IndexWriter> resSet(new IndexWriter());
+        std::wstring dataPath(fReader->getFilePath());
+
+        if (!resSet->initializeInMemory(
+            string_to_wstring(path),
+            dataPath,
+            preferredBuffSizeBytes, memoryBudgetBytes, overwriteIfExists, *_fileOpThread)) {
+            Logger::send(ERR, "Failed to create in-memory index writer");
+            return nullptr;
+        }
+        Logger::send(INFO, "Successfully created in-memory index writer");
+        return resSet.release();
+    }
+
+    void Core::releaseMemIndex(const std::string& path) {
+        std::wstring indexPath = windowsToUnixPath(string_to_wstring(path));
+        if (std::wstring::npos == getFileName(indexPath).find(string_to_wstring(FILE_INDEX_EXTENSION))) {
+            indexPath += string_to_wstring(FILE_INDEX_EXTENSION);
+        }
+        MemFileStore::remove(indexPath);
+    }
+
     void Core::release(FileReaderI* obj) {
         if (obj) {
             delete obj;
@@ -279,6 +354,25 @@ namespace PLP {
         );
     }
 
+    std::shared_ptr<FileReader> Core::createFileReaderExL(
+        const std::string& path,
+        unsigned long long preferredBuffSizeBytes,
+        int readerType
+    ) {
+        if (readerType != PAGED_READER_FSTREAM && readerType != PAGED_READER_MEMORY_MAPPED && readerType != PAGED_READER_IO_URING) {
+            Logger::send(ERR, "Unknown file reader type: " + std::to_string(readerType));
+            return nullptr;
+        }
+
+        std::function<void(int)> progressUpdate = [&](int percent) {
+            printConsoleL("Opening file: " + std::to_string(percent) + "%");
+        };
+
+        return std::shared_ptr<FileReader>(
+            static_cast<FileReader*>(createFileReader(path, preferredBuffSizeBytes, &progressUpdate, (PagedReaderType)readerType))
+        );
+    }
+
     std::shared_ptr<FileWriter> Core::createFileWriterL(
         const std::string& path,
         unsigned long long preferredBuffSizeBytes,
@@ -309,6 +403,38 @@ namespace PLP {
         );
     }
 
+    std::shared_ptr<IndexWriter> Core::createMemIndexWriterL(
+        const std::string& path,
+        unsigned long long preferredBuffSizeBytes,
+        unsigned long long memoryBudgetBytes,
+        const std::shared_ptr<FileReader> fReader,
+        bool overwriteIfExists
+    ) {
+        return std::shared_ptr<IndexWriter>(
+            static_cast<IndexWriter*>(createMemIndexWriter(path, preferredBuffSizeBytes, memoryBudgetBytes, fReader.get(), overwriteIfExists))
+        );
+    }
+
+    bool Core::cloneComparator(TextComparator* comparator, unsigned int numClones, std::vector<std::shared_ptr<TextComparator>>& clones) {
+        clones.clear();
+        if (!comparator->isCloneable()) {
+            return true;
+        }
+        for (unsigned int i = 0; i < numClones; i++) {
+            std::shared_ptr<TextComparator> clone = comparator->clone();
+            if (!clone) {
+                clones.clear();
+                return true;
+            }
+            if (!clone->initialize()) {
+                Logger::send(ERR, "Failed to initialize comparator");
+                return false;
+            }
+            clones.push_back(clone);
+        }
+        return true;
+    }
+
     bool Core::searchGeneral(
         FileReaderI* fileReader,
         IndexReaderI* indexReader,
@@ -342,6 +468,24 @@ namespace PLP {
             return false;
         }
 
+        // index searches read scattered lines and stay on this thread
+        const unsigned int numThreads = _searchThreadCount > 0 ? _searchThreadCount : _workerPool->getNumThreads();
+        if (!indexReader && numThreads > 1 && end - start >= ParallelScanner::CHUNK_NUM_LINES) {
+            std::vector<std::shared_ptr<TextComparator>> comparators;
+            if (!cloneComparator(comparator, numThreads, comparators)) {
+                return false;
+            }
+
+            if (comparators.size() == numThreads) {
+                bool success = searchParallel(fileReader, start, end, comparators, action, progressReporter);
+                for (auto& clone : comparators) {
+                    comparator->addStatsFrom(*clone);
+                }
+                return success;
+            }
+            Logger::send(INFO, "Comparator cannot be copied to other threads, searching on a single thread");
+        }
+
         LineScanner scanner(fileReader, indexReader, start, end);
         if (!scanner.initialize()) {
             Logger::send(ERR, "Failed to initialize line scanner");
@@ -356,22 +500,75 @@ namespace PLP {
         char* line;
         unsigned int lineSize;
 
-        LineReaderResult result;
-        while ((result = scanner.nextLine(lineNum, fileOffset, line, lineSize)) == LineReaderResult::SUCCESS) {
-            if (comparator->match(line, lineSize)) {
-                if (!action(lineNum, fileOffset, line, lineSize)) {
-                    break;
+        ComparatorPlan plan;
+        if (!plan.compile(comparator)) {
+            Logger::send(ERR, "Failed to compile comparator");
+            return false;
+        }
+
+        // lines are matched in batches and handed to the action in line order. Comparators that cannot be cloned
+        // (MatchCustom) may have side effects, so they see the lines one at a time and none past the last result
+        LineBatch batch(comparator->isCloneable() ? LineBatch::MAX_NUM_LINES : 1);
+        bool stopped = false;
+        auto flush = [&]() {
+            if (!stopped && !batch.match(plan, action)) {
+                stopped = true;
+            }
+        };
+        batch.attach(fileReader, flush);
+
+        // with a required literal only the lines containing it are split out of the pages. The scan
+        // goes in steps so that progress and cancellation are still handled between rare hits
+        const LiteralSearcher* literal = indexReader ? nullptr : comparator->getRequiredLiteral();
+        unsigned long long scanStepEnd = start;
+        auto nextLine = [&]() {
+            if (!literal) {
+                return scanner.nextLine(lineNum, fileOffset, line, lineSize);
+            }
+
+            LineReaderResult res;
+            while ((res = scanner.nextLineContaining(*literal, scanStepEnd, lineNum, fileOffset, line, lineSize)) == LineReaderResult::NOT_FOUND
+                && scanStepEnd < end && !_cancelled && !stopped) {
+                if (progressReporter.isUpdateDue(scanStepEnd)) {
+                    flush();
                 }
+                progressReporter.update(scanStepEnd);
+                scanStepEnd = std::min(end, scanStepEnd + LITERAL_SCAN_STEP_NUM_LINES);
             }
+            return res;
+        };
 
-            progressReporter.update(fileReader->getLineNumber());
-            currNumOps++;
-            if (currNumOps % numOpsTillCheckCancelled == 0 && _cancelled) {
-                Logger::send(INFO, "Canceled by user");
-                return false;
+        LineReaderResult result;
+        try {
+            while ((result = nextLine()) == LineReaderResult::SUCCESS && !stopped) {
+                batch.add(lineNum, fileOffset, line, lineSize);
+                const unsigned long long currLine = fileReader->getLineNumber();
+                if (batch.isFull() || progressReporter.isUpdateDue(currLine)) {
+                    flush();
+                    if (stopped) {
+                        break;
+                    }
+                }
+
+                progressReporter.update(currLine);
+                currNumOps++;
+                if ((literal || currNumOps % numOpsTillCheckCancelled == 0) && _cancelled) {
+                    Logger::send(INFO, "Canceled by user");
+                    return false;
+                }
+            }
+            if (!stopped && result != LineReaderResult::ERROR) {
+                flush();
             }
+        } catch (std::bad_alloc&) {
+            Logger::send(ERR, "Failed to allocate memory for search batch");
+            return false;
         }
 
+        if (literal && _cancelled) {
+            Logger::send(INFO, "Canceled by user");
+            return false;
+        }
         if (result == LineReaderResult::ERROR) {
             Logger::send(ERR, "Failed to get line");
             return false;
@@ -380,6 +577,125 @@ namespace PLP {
         return true;
     }
 
+    bool Core::searchParallel(
+        FileReaderI* fileReader,
+        unsigned long long start,
+        unsigned long long end,
+        const std::vector<std::shared_ptr<TextComparator>>& comparators,
+        const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& action,
+        LC::ProgressReporter& progressReporter
+    ) {
+        // matched lines are copied out by the workers and handed to the action in line order
+        std::vector<CollectedLines> matches(comparators.size());
+        auto beginChunk = [&](unsigned int slot) {
+            matches[slot].clear();
+        };
+
+        auto collect = [&](unsigned int slot, unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
+            matches[slot].add(lineNum, fileOffset, line, length);
+            return true;
+        };
+
+        auto merge = [&](unsigned int slot, unsigned long long endLine) {
+            const CollectedLines& slotMatches = matches[slot];
+            for (auto& match : slotMatches.getLines()) {
+                if (!action(match.lineNum, match.fileOffset, slotMatches.getData(match), match.size)) {
+                    return false;
+                }
+            }
+            progressReporter.update(endLine);
+            return true;
+        };
+
+        return matchParallel(fileReader, start, end, comparators, beginChunk, collect, merge);
+    }
+
+    bool Core::matchParallel(
+        FileReaderI* fileReader,
+        unsigned long long start,
+        unsigned long long end,
+        const std::vector<std::shared_ptr<TextComparator>>& comparators,
+        const std::function<void(unsigned int slot)>& beginChunk,
+        const std::function<bool(unsigned int slot, unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& onMatch,
+        const std::function<bool(unsigned int slot, unsigned long long endLine)>& mergeChunk
+    ) {
+        ParallelScanner scanner(fileReader, _workerPool.get(), (unsigned int)comparators.size(), start, end);
+        if (!scanner.initialize()) {
+            Logger::send(ERR, "Failed to initialize parallel scanner");
+            return false;
+        }
+
+        auto task = [&](unsigned int slot, FileReaderI* reader, unsigned long long startLine, unsigned long long endLine, const std::atomic<bool>& stop) {
+            beginChunk(slot);
+
+            LineScanner lineScanner(reader, nullptr, startLine, endLine);
+            if (!lineScanner.initialize()) {
+                return LineReaderResult::ERROR;
+            }
+
+            ComparatorPlan plan;
+            if (!plan.compile(comparators[slot].get())) {
+                return LineReaderResult::ERROR;
+            }
+            const LiteralSearcher* literal = comparators[slot]->getRequiredLiteral();
+            unsigned long long lineNum;
+            unsigned long long fileOffset;
+            char* line;
+            unsigned int lineSize;
+            unsigned long long currNumOps = 0;
+
+            auto nextLine = [&]() {
+                if (literal) {
+                    return lineScanner.nextLineContaining(*literal, endLine, lineNum, fileOffset, line, lineSize);
+                }
+                return lineScanner.nextLine(lineNum, fileOffset, line, lineSize);
+            };
+
+            auto onSlotMatch = [&](unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
+                return onMatch(slot, lineNum, fileOffset, line, length);
+            };
+
+            LineBatch batch;
+            auto flush = [&]() {
+                batch.match(plan, onSlotMatch);
+            };
+            batch.attach(reader, flush);
+
+            LineReaderResult result;
+            try {
+                while ((result = nextLine()) == LineReaderResult::SUCCESS) {
+                    batch.add(lineNum, fileOffset, line, lineSize);
+                    if (batch.isFull()) {
+                        flush();
+                    }
+
+                    currNumOps++;
+                    if (currNumOps % 10000 == 0 && stop) {
+                        break;
+                    }
+                }
+                if (result != LineReaderResult::ERROR) {
+                    flush();
+                }
+            } catch (std::bad_alloc&) {
+                Logger::send(ERR, "Failed to allocate memory for search results");
+                return LineReaderResult::ERROR;
+            }
+            return result == LineReaderResult::ERROR ? LineReaderResult::ERROR : LineReaderResult::SUCCESS;
+        };
+
+        if (!scanner.run(task, mergeChunk, _cancelled)) {
+            if (_cancelled) {
+                Logger::send(INFO, "Canceled by user");
+            } else {
+                Logger::send(ERR, "Failed to get line");
+            }
+            return false;
+        }
+
+        return true;
+    }
+
     bool Core::searchMultilineGeneral(
         FileReaderI* fileReader,
         IndexReaderI* indexReader,
@@ -416,117 +732,419 @@ namespace PLP {
             return false;
         }
 
+        std::vector<ComparatorPlan> plans(vLineComparators.size());
+        for (size_t i = 0; i < vLineComparators.size(); i++) {
+            if (!plans[i].compile(vLineComparators[i].second)) {
+                Logger::send(ERR, "Failed to compile comparator");
+                return false;
+            }
+        }
+
         LC::ProgressReporter progressReporter;
         if (!progressReporter.initialize(start, end, progressUpdate)) {
             Logger::send(ERR, "Progress reporter failed to initialize");
             return false;
         }
 
-        MultilineScanner scanner(fileReader, indexReader, 
-            vLineComparators[0].first, vLineComparators[vLineComparators.size() - 1].first, 
-            start, end
-        );
-        if (!scanner.initialize()) {
-            Logger::send(ERR, "Failed to initialize multi-line scanner");
+        // The anchor is the comparator expected to match the fewest lines. It is evaluated on its own, and only the frames
+        // of the lines it matches are read. Comparators with a required literal let the scan skip through pages without
+        // splitting them into lines, so they are preferred, the longer the literal the better. Otherwise the cheapest one is used
+        size_t anchor = 0;
+        for (size_t i = 1; i < vLineComparators.size(); i++) {
+            const LiteralSearcher* literal = vLineComparators[i].second->getRequiredLiteral();
+            const LiteralSearcher* anchorLiteral = vLineComparators[anchor].second->getRequiredLiteral();
+            bool better;
+            if ((literal != nullptr) != (anchorLiteral != nullptr)) {
+                better = literal != nullptr;
+            } else if (literal && literal->getNeedleSize() != anchorLiteral->getNeedleSize()) {
+                better = literal->getNeedleSize() > anchorLiteral->getNeedleSize();
+            } else {
+                better = vLineComparators[i].second->getCost() < vLineComparators[anchor].second->getCost();
+            }
+            if (better) {
+                anchor = i;
+            }
+        }
+        const int anchorOffset = vLineComparators[anchor].first;
+        const unsigned long long numLines = fileReader->getNumberOfLines();
+        if (end >= numLines) {
+            Logger::send(ERR, "End line is past the end of the file");
             return false;
         }
 
-        const unsigned long long numOpsTillCheckCancelled = indexReader ? 1000 : 1000000;
-        unsigned long long currNumOps = 0;
-
+        char emptyLine[1] = { 0 };
         unsigned long long lineNum;
         unsigned long long fileOffset;
         char* line;
         unsigned int lineSize;
 
-        bool matched = true;
-        LineReaderResult result;
-        while ((result = scanner.nextFrame()) == LineReaderResult::SUCCESS) {
-            for (auto& comparator : vLineComparators) {
-                if (!scanner.getLine(comparator.first, lineNum, fileOffset, line, lineSize)) {
+        // lines of the frame that are outside of the file are matched as empty lines
+        auto getFrameLine = [&](FrameReader& reader, unsigned long long refLine, int offset) {
+            if ((offset < 0 && refLine < (unsigned long long)-offset) || (offset > 0 && refLine + offset >= numLines)) {
+                line = emptyLine;
+                lineSize = 0;
+                return LineReaderResult::SUCCESS;
+            }
+            return reader.getLine(refLine + offset, fileOffset, line, lineSize);
+        };
+
+        // checks the frame of refLine against every comparator but the anchor, reading its lines in order. The reference
+        // line is read first when it comes before all of them, so that it is still buffered when a match is reported
+        bool stopped = false;
+        auto matchFrame = [&](FrameReader& reader, unsigned long long refLine) {
+            if (vLineComparators.front().first > 0 && getFrameLine(reader, refLine, 0) != LineReaderResult::SUCCESS) {
+                return false;
+            }
+            for (size_t i = 0; i < vLineComparators.size(); i++) {
+                if (i == anchor) {
+                    continue;
+                }
+                if (getFrameLine(reader, refLine, vLineComparators[i].first) != LineReaderResult::SUCCESS) {
                     return false;
                 }
-                if (!comparator.second->match(line, lineSize)) {
-                    matched = false;
-                    break;
+                if (!plans[i].match(line, lineSize)) {
+                    return true;
                 }
-                matched = true;
             }
-            if (matched) {
-                if (!scanner.getLine(0, lineNum, fileOffset, line, lineSize)) {
+
+            if (reader.getLine(refLine, fileOffset, line, lineSize) != LineReaderResult::SUCCESS) {
+                return false;
+            }
+            stopped = !action(refLine, fileOffset, line, lineSize);
+            return true;
+        };
+
+        auto matchRef = [&](FrameReader& reader, unsigned long long refLine) {
+            if (getFrameLine(reader, refLine, anchorOffset) != LineReaderResult::SUCCESS) {
+                return false;
+            }
+            if (!plans[anchor].match(line, lineSize)) {
+                return true;
+            }
+            return matchFrame(reader, refLine);
+        };
+
+        const unsigned int frameSize = (unsigned int)(std::max(vLineComparators.back().first, 0) - std::min(vLineComparators.front().first, 0) + 1);
+        if (indexReader) {
+            FrameReader frameReader(fileReader, frameSize);
+            if (!frameReader.initialize()) {
+                Logger::send(ERR, "Failed to initialize frame reader");
+                return false;
+            }
+
+            if (!indexReader->seekToLine(start)) {
+                return true;
+            }
+
+            unsigned long long refLine;
+            unsigned long long currNumOps = 0;
+            while (!stopped && indexReader->nextResult(refLine) && refLine <= end) {
+                if (!matchRef(frameReader, refLine)) {
+                    Logger::send(ERR, "Failed to get line");
+                    return false;
+                }
+
+                progressReporter.update(refLine);
+                currNumOps++;
+                if (currNumOps % 1000 == 0 && _cancelled) {
+                    Logger::send(INFO, "Canceled by user");
                     return false;
                 }
-                if (!action(lineNum, fileOffset, line, lineSize)) {
-                    break;
+            }
+            return true;
+        }
+
+        // frames are read by a second reader so that the anchor scan keeps its position
+        std::unique_ptr<FileReaderI> contextReader;
+        std::unique_ptr<FrameReader> frameReader;
+        auto getFrameReader = [&]() {
+            if (!frameReader) {
+                contextReader.reset(fileReader->clone());
+                if (!contextReader) {
+                    Logger::send(ERR, "Failed to open file for reading multi-line frames");
+                    return (FrameReader*)nullptr;
+                }
+                frameReader.reset(new FrameReader(contextReader.get(), frameSize));
+                if (!frameReader->initialize()) {
+                    Logger::send(ERR, "Failed to initialize frame reader");
+                    frameReader.reset();
+                    return (FrameReader*)nullptr;
+                }
+            }
+            return frameReader.get();
+        };
+        auto matchRefs = [&](unsigned long long first, unsigned long long last) {
+            for (unsigned long long refLine = first; refLine <= last && !stopped; refLine++) {
+                FrameReader* reader = getFrameReader();
+                if (!reader || !matchRef(*reader, refLine)) {
+                    return false;
                 }
             }
+            return true;
+        };
 
-            progressReporter.update(fileReader->getLineNumber());
-            currNumOps++;
-            if (currNumOps % numOpsTillCheckCancelled == 0 && _cancelled) {
-                Logger::send(INFO, "Canceled by user");
+        // references whose anchor line is outside of the file are checked one by one, the rest by scanning the anchor lines
+        unsigned long long scanStart = start;
+        unsigned long long scanEnd = end;
+        bool scan = true;
+        if (anchorOffset < 0) {
+            scanStart = std::max(start, (unsigned long long)-anchorOffset);
+            scan = scanStart <= scanEnd;
+            if (!matchRefs(start, std::min(end, scanStart - 1))) {
                 return false;
             }
+        } else if (anchorOffset > 0) {
+            scan = numLines > (unsigned long long)anchorOffset && start <= numLines - 1 - anchorOffset;
+            scanEnd = scan ? std::min(end, numLines - 1 - anchorOffset) : 0;
         }
 
-        if (result == LineReaderResult::ERROR) {
-            Logger::send(ERR, "Failed to get line");
-            return false;
-        }
+        if (!stopped && scan) {
+            const unsigned long long anchorStart = scanStart + anchorOffset;
+            const unsigned long long anchorEnd = scanEnd + anchorOffset;
+            if (anchorEnd == 0) { // the scanner would read to the end of the file
+                if (!matchRefs(scanStart, scanEnd)) {
+                    return false;
+                }
+            } else {
+                LineScanner scanner(fileReader, nullptr, anchorStart, anchorEnd);
+                if (!scanner.initialize()) {
+                    Logger::send(ERR, "Failed to initialize line scanner");
+                    return false;
+                }
 
-        return true;
-    }
+                const LiteralSearcher* literal = vLineComparators[anchor].second->getRequiredLiteral();
+                unsigned long long scanStepEnd = anchorStart;
+                auto nextLine = [&]() {
+                    if (!literal) {
+                        return scanner.nextLine(lineNum, fileOffset, line, lineSize);
+                    }
+
+                    LineReaderResult res;
+                    while ((res = scanner.nextLineContaining(*literal, scanStepEnd, lineNum, fileOffset, line, lineSize)) == LineReaderResult::NOT_FOUND
+                        && scanStepEnd < anchorEnd && !_cancelled) {
+                        progressReporter.update(scanStepEnd - anchorOffset);
+                        scanStepEnd = std::min(anchorEnd, scanStepEnd + LITERAL_SCAN_STEP_NUM_LINES);
+                    }
+                    return res;
+                };
+
+                unsigned long long currNumOps = 0;
+                LineReaderResult result;
+                while (!stopped && (result = nextLine()) == LineReaderResult::SUCCESS) {
+                    if (plans[anchor].match(line, lineSize)) {
+                        FrameReader* reader = getFrameReader();
+                        if (!reader || !matchFrame(*reader, lineNum - anchorOffset)) {
+                            return false;
+                        }
+                    }
+
+                    progressReporter.update(lineNum - anchorOffset);
+                    currNumOps++;
+                    if ((literal || currNumOps % 1000000 == 0) && _cancelled) {
+                        Logger::send(INFO, "Canceled by user");
+                        return false;
+                    }
+                }
 
-    bool Core::search(
-        FileReaderI* fileReader,
-        IndexReaderI* indexReader,
-        IndexWriterI* indexWriter,
-        unsigned long long start,
-        unsigned long long end, //0 for end of file, inclusive
-        unsigned long long maxNumResults,
-        TextComparator* comparator,
-        const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
-    ) {
-        maxNumResults = maxNumResults > 0 ? maxNumResults : ULLONG_MAX;
-        auto action = [maxNumResults, indexWriter](unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
-            if (!indexWriter->appendCurrLine(lineNum, fileOffset) || indexWriter->getNumResults() >= maxNumResults) {
+                if (literal && _cancelled) {
+                    Logger::send(INFO, "Canceled by user");
+                    return false;
+                }
+                if (result == LineReaderResult::ERROR) {
+                    Logger::send(ERR, "Failed to get line");
+                    return false;
+                }
+            }
+        }
+
+        if (!stopped && anchorOffset > 0) {
+            const unsigned long long trailStart = std::max(start, numLines > (unsigned long long)anchorOffset ? numLines - anchorOffset : 0ULL);
+            if (trailStart <= end && !matchRefs(trailStart, end)) {
                 return false;
             }
-            return true;
-        };
+        }
 
-        std::function<void(int)> progressUpdateInt = [&](int percent) {
-            (*progressUpdate)(percent, indexWriter->getNumResults());
-        };
-        return searchGeneral(
-            fileReader,
-            indexReader,
-            start,
-            end,
-            comparator,
-            action,
-            &progressUpdateInt
-        );
+        return true;
     }
 
-    bool Core::searchMultiline(
+    bool Core::searchSequenceGeneral(
         FileReaderI* fileReader,
         IndexReaderI* indexReader,
-        IndexWriterI* indexWriter,
         unsigned long long start,
-        unsigned long long end, //0 for end of file, inclusive
-        unsigned long long maxNumResults,
-        const std::unordered_map<int, TextComparator*>& lineComparators,
-        const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+        unsigned long long end,
+        const std::vector<TextComparator*>& steps,
+        const std::vector<unsigned long long>& maxGaps,
+        const std::vector<int>& keyWords,
+        bool lastStepAbsent,
+        const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)> action,
+        const std::function<void(int percent)>* progressUpdate
     ) {
-        maxNumResults = maxNumResults > 0 ? maxNumResults : ULLONG_MAX;
-        auto action = [maxNumResults, indexWriter](unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
-            if (!indexWriter->appendCurrLine(lineNum, fileOffset) || indexWriter->getNumResults() >= maxNumResults) {
+        _cancelled = false;
+
+        if (fileReader == nullptr) {
+            Logger::send(ERR, "File reader cannot be null");
+            return false;
+        }
+        if (steps.empty()) {
+            Logger::send(ERR, "Sequence must have at least one step");
+            return false;
+        }
+        for (TextComparator* step : steps) {
+            if (step == nullptr) {
+                Logger::send(ERR, "Comparator cannot be null");
                 return false;
             }
-            return true;
-        };
-
+        }
+        if (maxGaps.size() != steps.size() - 1) {
+            Logger::send(ERR, "Sequence must have one maximum gap per step after the first");
+            return false;
+        }
+        if (!keyWords.empty() && keyWords.size() != steps.size()) {
+            Logger::send(ERR, "Sequence must have one key word per step or none");
+            return false;
+        }
+        if (lastStepAbsent && (steps.size() < 2 || maxGaps.back() == 0)) {
+            Logger::send(ERR, "An absent last step requires a previous step and a maximum gap");
+            return false;
+        }
+
+        end = end > 0 ? end : fileReader->getNumberOfLines() - 1;
+        if (start > end) {
+            Logger::send(ERR, "Start line must be smaller or equal to end line");
+            return false;
+        }
+
+        SequenceMatcher matcher(steps, maxGaps, keyWords, lastStepAbsent);
+        if (!matcher.initialize()) {
+            Logger::send(ERR, "Failed to initialize sequence matcher");
+            return false;
+        }
+
+        LC::ProgressReporter progressReporter;
+        if (!progressReporter.initialize(start, end, progressUpdate)) {
+            Logger::send(ERR, "Progress reporter failed to initialize");
+            return false;
+        }
+
+        LineScanner scanner(fileReader, indexReader, start, end);
+        if (!scanner.initialize()) {
+            Logger::send(ERR, "Failed to initialize line scanner");
+            return false;
+        }
+
+        const unsigned long long numOpsTillCheckCancelled = indexReader ? 1000 : 1000000;
+        unsigned long long currNumOps = 0;
+
+        unsigned long long lineNum;
+        unsigned long long fileOffset;
+        char* line;
+        unsigned int lineSize;
+
+        // gaps are counted in lines, so every line is read while a sequence is in progress.
+        // Otherwise only the lines that can start one are split out of the pages
+        const LiteralSearcher* literal = indexReader ? nullptr : steps[0]->getRequiredLiteral();
+        unsigned long long scanStepEnd = start;
+        auto nextLine = [&]() {
+            if (!literal || matcher.isWaiting()) {
+                return scanner.nextLine(lineNum, fileOffset, line, lineSize);
+            }
+
+            LineReaderResult res;
+            while ((res = scanner.nextLineContaining(*literal, scanStepEnd, lineNum, fileOffset, line, lineSize)) == LineReaderResult::NOT_FOUND
+                && scanStepEnd < end && !_cancelled) {
+                progressReporter.update(scanStepEnd);
+                scanStepEnd = std::min(end, scanStepEnd + LITERAL_SCAN_STEP_NUM_LINES);
+            }
+            return res;
+        };
+
+        LineReaderResult result;
+        try {
+            while ((result = nextLine()) == LineReaderResult::SUCCESS) {
+                if (!matcher.nextLine(lineNum, fileOffset, line, lineSize, action)) {
+                    return true;
+                }
+
+                progressReporter.update(fileReader->getLineNumber());
+                currNumOps++;
+                if ((literal || currNumOps % numOpsTillCheckCancelled == 0) && _cancelled) {
+                    Logger::send(INFO, "Canceled by user");
+                    return false;
+                }
+            }
+        } catch (std::bad_alloc&) {
+            Logger::send(ERR, "Failed to allocate memory for sequence search");
+            return false;
+        }
+
+        if (literal && _cancelled) {
+            Logger::send(INFO, "Canceled by user");
+            return false;
+        }
+        if (result == LineReaderResult::ERROR) {
+            Logger::send(ERR, "Failed to get line");
+            return false;
+        }
+
+        try {
+            matcher.finish(action);
+        } catch (std::bad_alloc&) {
+            Logger::send(ERR, "Failed to allocate memory for sequence search");
+            return false;
+        }
+        return true;
+    }
+
+    bool Core::search(
+        FileReaderI* fileReader,
+        IndexReaderI* indexReader,
+        IndexWriterI* indexWriter,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        unsigned long long maxNumResults,
+        TextComparator* comparator,
+        const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+    ) {
+        maxNumResults = maxNumResults > 0 ? maxNumResults : ULLONG_MAX;
+        auto action = [maxNumResults, indexWriter](unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
+            if (!indexWriter->appendCurrLine(lineNum, fileOffset) || indexWriter->getNumResults() >= maxNumResults) {
+                return false;
+            }
+            return true;
+        };
+
+        std::function<void(int)> progressUpdateInt = [&](int percent) {
+            (*progressUpdate)(percent, indexWriter->getNumResults());
+        };
+        return searchGeneral(
+            fileReader,
+            indexReader,
+            start,
+            end,
+            comparator,
+            action,
+            &progressUpdateInt
+        );
+    }
+
+    bool Core::searchMultiline(
+        FileReaderI* fileReader,
+        IndexReaderI* indexReader,
+        IndexWriterI* indexWriter,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        unsigned long long maxNumResults,
+        const std::unordered_map<int, TextComparator*>& lineComparators,
+        const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+    ) {
+        maxNumResults = maxNumResults > 0 ? maxNumResults : ULLONG_MAX;
+        auto action = [maxNumResults, indexWriter](unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
+            if (!indexWriter->appendCurrLine(lineNum, fileOffset) || indexWriter->getNumResults() >= maxNumResults) {
+                return false;
+            }
+            return true;
+        };
+
         std::function<void(int)> progressUpdateInt = [&](int percent) {
             (*progressUpdate)(percent, indexWriter->getNumResults());
         };
@@ -541,6 +1159,332 @@ namespace PLP {
         );
     }
 
+    bool Core::searchSequence(
+        FileReaderI* fileReader,
+        IndexReaderI* indexReader,
+        IndexWriterI* indexWriter,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        unsigned long long maxNumResults,
+        const std::vector<TextComparator*>& steps,
+        const std::vector<unsigned long long>& maxGaps,
+        const std::vector<int>& keyWords,
+        bool lastStepAbsent,
+        const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+    ) {
+        maxNumResults = maxNumResults > 0 ? maxNumResults : ULLONG_MAX;
+        auto action = [maxNumResults, indexWriter](unsigned long long lineNum, unsigned long long fileOffset) {
+            if (!indexWriter->appendCurrLine(lineNum, fileOffset) || indexWriter->getNumResults() >= maxNumResults) {
+                return false;
+            }
+            return true;
+        };
+
+        std::function<void(int)> progressUpdateInt = [&](int percent) {
+            (*progressUpdate)(percent, indexWriter->getNumResults());
+        };
+        return searchSequenceGeneral(
+            fileReader,
+            indexReader,
+            start,
+            end,
+            steps,
+            maxGaps,
+            keyWords,
+            lastStepAbsent,
+            action,
+            &progressUpdateInt
+        );
+    }
+
+    bool Core::searchMany(
+        FileReaderI* fileReader,
+        IndexReaderI* indexReader,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        const std::vector<SearchQuery>& queries,
+        const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+    ) {
+        _cancelled = false;
+
+        if (fileReader == nullptr) {
+            Logger::send(ERR, "File reader cannot be null");
+            return false;
+        }
+        if (queries.empty()) {
+            Logger::send(ERR, "No queries to search for");
+            return false;
+        }
+        for (const SearchQuery& query : queries) {
+            if (query.comparator == nullptr || query.indexWriter == nullptr) {
+                Logger::send(ERR, "Comparator and index writer cannot be null");
+                return false;
+            }
+        }
+
+        end = end > 0 ? end : fileReader->getNumberOfLines() - 1;
+        if (start > end) {
+            Logger::send(ERR, "Start line must be smaller or equal to end line");
+            return false;
+        }
+
+        std::vector<ComparatorPlan> plans(queries.size());
+        std::vector<unsigned long long> maxNumResults;
+        bool cloneable = true;
+        for (size_t i = 0; i < queries.size(); i++) {
+            if (!plans[i].compile(queries[i].comparator)) {
+                Logger::send(ERR, "Failed to compile comparator");
+                return false;
+            }
+            maxNumResults.push_back(queries[i].maxNumResults > 0 ? queries[i].maxNumResults : ULLONG_MAX);
+            cloneable = cloneable && queries[i].comparator->isCloneable();
+        }
+        std::vector<unsigned char> active(queries.size(), 1);
+        size_t numActive = queries.size();
+
+        auto getNumResults = [&]() {
+            unsigned long long numResults = 0;
+            for (const SearchQuery& query : queries) {
+                numResults += query.indexWriter->getNumResults();
+            }
+            return numResults;
+        };
+
+        std::function<void(int)> progressUpdateInt = [&](int percent) {
+            (*progressUpdate)(percent, getNumResults());
+        };
+
+        LC::ProgressReporter progressReporter;
+        if (!progressReporter.initialize(start, end, progressUpdate ? &progressUpdateInt : nullptr)) {
+            Logger::send(ERR, "Progress reporter failed to initialize");
+            return false;
+        }
+
+        LineScanner scanner(fileReader, indexReader, start, end);
+        if (!scanner.initialize()) {
+            Logger::send(ERR, "Failed to initialize line scanner");
+            return false;
+        }
+
+        // every query matches the same batch of lines, so the file is read and split only once
+        auto action = [&](size_t index, unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
+            IndexWriterI* indexWriter = queries[index].indexWriter;
+            if (!indexWriter->appendCurrLine(lineNum, fileOffset) || indexWriter->getNumResults() >= maxNumResults[index]) {
+                numActive--;
+                return false;
+            }
+            return true;
+        };
+
+        const unsigned long long numOpsTillCheckCancelled = indexReader ? 1000 : 1000000;
+        unsigned long long currNumOps = 0;
+
+        unsigned long long lineNum;
+        unsigned long long fileOffset;
+        char* line;
+        unsigned int lineSize;
+
+        // as in searchGeneral, queries that cannot be cloned (MatchCustom) see the lines one at a time
+        LineBatch batch(cloneable ? LineBatch::MAX_NUM_LINES : 1);
+        auto flush = [&]() {
+            if (numActive > 0) {
+                batch.matchEach(plans, active, action);
+            }
+        };
+        batch.attach(fileReader, flush);
+
+        LineReaderResult result;
+        try {
+            while ((result = scanner.nextLine(lineNum, fileOffset, line, lineSize)) == LineReaderResult::SUCCESS && numActive > 0) {
+                batch.add(lineNum, fileOffset, line, lineSize);
+                const unsigned long long currLine = fileReader->getLineNumber();
+                if (batch.isFull() || progressReporter.isUpdateDue(currLine)) {
+                    flush();
+                    if (numActive == 0) {
+                        return true;
+                    }
+                }
+
+                progressReporter.update(currLine);
+                currNumOps++;
+                if (currNumOps % numOpsTillCheckCancelled == 0 && _cancelled) {
+                    Logger::send(INFO, "Canceled by user");
+                    return false;
+                }
+            }
+            if (result != LineReaderResult::ERROR) {
+                flush();
+            }
+        } catch (std::bad_alloc&) {
+            Logger::send(ERR, "Failed to allocate memory for search batch");
+            return false;
+        }
+
+        if (result == LineReaderResult::ERROR) {
+            Logger::send(ERR, "Failed to get line");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Core::mergeIndexes(
+        const std::vector<IndexReaderI*>& indexReaders,
+        IndexWriterI* indexWriter,
+        IndexSetOperation operation,
+        unsigned long long maxNumResults
+    ) {
+        _cancelled = false;
+
+        if (indexReaders.empty()) {
+            Logger::send(ERR, "No indexes to combine");
+            return false;
+        }
+        if (indexWriter == nullptr) {
+            Logger::send(ERR, "Index writer cannot be null");
+            return false;
+        }
+        for (IndexReaderI* indexReader : indexReaders) {
+            if (indexReader == nullptr) {
+                Logger::send(ERR, "Index reader cannot be null");
+                return false;
+            }
+            if (strcmp(indexReader->getDataFilePath(), indexReaders[0]->getDataFilePath()) != 0) {
+                Logger::send(ERR, "Indexes must belong to the same file");
+                return false;
+            }
+        }
+
+        // the cursors would share the read position of a reader that is passed twice
+        for (size_t i = 0; i < indexReaders.size(); i++) {
+            if (std::find(indexReaders.begin() + i + 1, indexReaders.end(), indexReaders[i]) != indexReaders.end()) {
+                Logger::send(ERR, "The same index reader cannot be passed more than once");
+                return false;
+            }
+        }
+
+        IndexMerger merger(indexReaders, operation);
+        if (!merger.initialize()) {
+            Logger::send(ERR, "Failed to initialize index merger");
+            return false;
+        }
+
+        maxNumResults = maxNumResults > 0 ? maxNumResults : ULLONG_MAX;
+        bool writeError = false;
+        auto onResult = [&](unsigned long long lineNum, unsigned long long fileOffset) {
+            if (!indexWriter->appendCurrLine(lineNum, fileOffset)) {
+                writeError = true;
+                return false;
+            }
+            return indexWriter->getNumResults() < maxNumResults;
+        };
+
+        if (!merger.run(onResult, _cancelled)) {
+            if (_cancelled) {
+                Logger::send(INFO, "Canceled by user");
+            } else {
+                Logger::send(ERR, "Failed to read index");
+            }
+            return false;
+        }
+        if (writeError) {
+            Logger::send(ERR, "Failed to write index");
+            return false;
+        }
+
+        return true;
+    }
+
+    bool Core::count(
+        FileReaderI* fileReader,
+        IndexReaderI* indexReader,
+        unsigned long long start,
+        unsigned long long end,
+        TextComparator* comparator,
+        unsigned int numBuckets,
+        MatchCount& result,
+        const std::function<void(int percent, unsigned long long numMatches)>* progressUpdate
+    ) {
+        _cancelled = false;
+
+        if (fileReader == nullptr) {
+            Logger::send(ERR, "File reader cannot be null");
+            return false;
+        }
+        if (comparator == nullptr) {
+            Logger::send(ERR, "Comparator cannot be null");
+            return false;
+        }
+
+        end = end > 0 ? end : fileReader->getNumberOfLines() - 1;
+        if (start > end) {
+            Logger::send(ERR, "Start line must be smaller or equal to end line");
+            return false;
+        }
+        if (!result.initialize(start, end, numBuckets)) {
+            Logger::send(ERR, "Failed to allocate match histogram");
+            return false;
+        }
+
+        std::function<void(int)> progressUpdateInt = [&](int percent) {
+            if (progressUpdate) {
+                (*progressUpdate)(percent, result.getNumMatches());
+            }
+        };
+
+        // the chunks are counted separately on the workers and the partial counts are summed in chunk order
+        const unsigned int numThreads = _searchThreadCount > 0 ? _searchThreadCount : _workerPool->getNumThreads();
+        if (!indexReader && numThreads > 1 && end - start >= ParallelScanner::CHUNK_NUM_LINES) {
+            std::vector<std::shared_ptr<TextComparator>> comparators;
+            if (!cloneComparator(comparator, numThreads, comparators)) {
+                return false;
+            }
+
+            if (comparators.size() == numThreads) {
+                LC::ProgressReporter progressReporter;
+                if (!progressReporter.initialize(start, end, &progressUpdateInt)) {
+                    Logger::send(ERR, "Progress reporter failed to initialize");
+                    return false;
+                }
+
+                std::vector<MatchCount> slotCounts(numThreads);
+                for (auto& slotCount : slotCounts) {
+                    if (!slotCount.initialize(start, end, numBuckets)) {
+                        Logger::send(ERR, "Failed to allocate match histogram");
+                        return false;
+                    }
+                }
+
+                auto beginChunk = [&](unsigned int slot) {
+                    slotCounts[slot].clear();
+                };
+
+                auto countMatch = [&](unsigned int slot, unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
+                    slotCounts[slot].add(lineNum);
+                    return true;
+                };
+
+                auto merge = [&](unsigned int slot, unsigned long long endLine) {
+                    result.merge(slotCounts[slot]);
+                    progressReporter.update(endLine);
+                    return true;
+                };
+
+                bool success = matchParallel(fileReader, start, end, comparators, beginChunk, countMatch, merge);
+                for (auto& clone : comparators) {
+                    comparator->addStatsFrom(*clone);
+                }
+                return success;
+            }
+        }
+
+        auto action = [&result](unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length) {
+            result.add(lineNum);
+            return true;
+        };
+        return searchGeneral(fileReader, indexReader, start, end, comparator, action, &progressUpdateInt);
+    }
+
     bool Core::searchL(
         std::shared_ptr<FileReader> fileReader,
         std::shared_ptr<IndexWriter> indexWriter,
@@ -649,6 +1593,171 @@ namespace PLP {
         );
     }
 
+    bool Core::searchSequenceL(
+        std::shared_ptr<FileReader> fileReader,
+        std::shared_ptr<IndexWriter> indexWriter,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        unsigned long long maxNumResults,
+        const std::vector<std::shared_ptr<TextComparator>>& steps,
+        const std::vector<unsigned long long>& maxGaps,
+        const std::vector<int>& keyWords,
+        bool lastStepAbsent
+    ) {
+        return searchSequenceIL(fileReader, nullptr, indexWriter, start, end, maxNumResults, steps, maxGaps, keyWords, lastStepAbsent);
+    }
+
+    bool Core::searchSequenceIL(
+        std::shared_ptr<FileReader> fileReader,
+        std::shared_ptr<IndexReader> indexReader,
+        std::shared_ptr<IndexWriter> indexWriter,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        unsigned long long maxNumResults,
+        const std::vector<std::shared_ptr<TextComparator>>& steps,
+        const std::vector<unsigned long long>& maxGaps,
+        const std::vector<int>& keyWords,
+        bool lastStepAbsent
+    ) {
+        std::function<void(int, unsigned long long)> progressUpdate = [&](int percent, unsigned long long numResults) {
+            printConsoleL(std::to_string(percent) + "%, Found results: " + std::to_string(numResults));
+        };
+
+        std::vector<TextComparator*> comparators;
+        for (auto& step : steps) {
+            comparators.push_back(step.get());
+        }
+
+        return searchSequence(
+            fileReader.get(),
+            indexReader.get(),
+            indexWriter.get(),
+            start,
+            end,
+            maxNumResults,
+            comparators,
+            maxGaps,
+            keyWords,
+            lastStepAbsent,
+            &progressUpdate
+        );
+    }
+
+    bool Core::searchManyL(
+        std::shared_ptr<FileReader> fileReader,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        const std::vector<std::shared_ptr<TextComparator>>& comparators,
+        const std::vector<std::shared_ptr<IndexWriter>>& indexWriters,
+        const std::vector<unsigned long long>& maxNumResults
+    ) {
+        return searchManyIL(fileReader, nullptr, start, end, comparators, indexWriters, maxNumResults);
+    }
+
+    bool Core::searchManyIL(
+        std::shared_ptr<FileReader> fileReader,
+        std::shared_ptr<IndexReader> indexReader,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        const std::vector<std::shared_ptr<TextComparator>>& comparators,
+        const std::vector<std::shared_ptr<IndexWriter>>& indexWriters,
+        const std::vector<unsigned long long>& maxNumResults
+    ) {
+        if (comparators.size() != indexWriters.size() || (!maxNumResults.empty() && maxNumResults.size() != comparators.size())) {
+            Logger::send(ERR, "Each comparator must have an index writer and a maximum number of results");
+            return false;
+        }
+
+        std::function<void(int, unsigned long long)> progressUpdate = [&](int percent, unsigned long long numResults) {
+            printConsoleL(std::to_string(percent) + "%, Found results: " + std::to_string(numResults));
+        };
+
+        std::vector<SearchQuery> queries;
+        for (size_t i = 0; i < comparators.size(); i++) {
+            queries.push_back({ comparators[i].get(), indexWriters[i].get(), maxNumResults.empty() ? 0 : maxNumResults[i] });
+        }
+
+        return searchMany(
+            fileReader.get(),
+            indexReader.get(),
+            start,
+            end,
+            queries,
+            &progressUpdate
+        );
+    }
+
+    bool Core::mergeIndexesL(
+        const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+        std::shared_ptr<IndexWriter> indexWriter,
+        IndexSetOperation operation,
+        unsigned long long maxNumResults
+    ) {
+        std::vector<IndexReaderI*> readers;
+        for (const std::shared_ptr<IndexReader>& indexReader : indexReaders) {
+            readers.push_back(indexReader.get());
+        }
+
+        if (!mergeIndexes(readers, indexWriter.get(), operation, maxNumResults)) {
+            return false;
+        }
+        printConsoleL("Combined results: " + std::to_string(indexWriter->getNumResults()));
+        return true;
+    }
+
+    bool Core::indexUnionL(
+        const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+        std::shared_ptr<IndexWriter> indexWriter,
+        unsigned long long maxNumResults
+    ) {
+        return mergeIndexesL(indexReaders, indexWriter, INDEX_UNION, maxNumResults);
+    }
+
+    bool Core::indexIntersectionL(
+        const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+        std::shared_ptr<IndexWriter> indexWriter,
+        unsigned long long maxNumResults
+    ) {
+        return mergeIndexesL(indexReaders, indexWriter, INDEX_INTERSECTION, maxNumResults);
+    }
+
+    bool Core::indexDifferenceL(
+        const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+        std::shared_ptr<IndexWriter> indexWriter,
+        unsigned long long maxNumResults
+    ) {
+        return mergeIndexesL(indexReaders, indexWriter, INDEX_DIFFERENCE, maxNumResults);
+    }
+
+    std::tuple<bool, unsigned long long, unsigned long long, unsigned long long, std::vector<unsigned long long>> Core::countL(
+        std::shared_ptr<FileReader> fileReader,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        std::shared_ptr<TextComparator> comparator,
+        unsigned int numBuckets
+    ) {
+        return countIL(fileReader, nullptr, start, end, comparator, numBuckets);
+    }
+
+    std::tuple<bool, unsigned long long, unsigned long long, unsigned long long, std::vector<unsigned long long>> Core::countIL(
+        std::shared_ptr<FileReader> fileReader,
+        std::shared_ptr<IndexReader> indexReader,
+        unsigned long long start,
+        unsigned long long end, //0 for end of file, inclusive
+        std::shared_ptr<TextComparator> comparator,
+        unsigned int numBuckets
+    ) {
+        std::function<void(int, unsigned long long)> progressUpdate = [&](int percent, unsigned long long numMatches) {
+            printConsoleL(std::to_string(percent) + "%, Found results: " + std::to_string(numMatches));
+        };
+
+        MatchCount result;
+        if (!count(fileReader.get(), indexReader.get(), start, end, comparator.get(), numBuckets, result, &progressUpdate)) {
+            return std::make_tuple(false, 0ULL, 0ULL, 0ULL, std::vector<unsigned long long>());
+        }
+        return std::make_tuple(true, result.getNumMatches(), result.getFirstLine(), result.getLastLine(), result.getBuckets());
+    }
+
     void Core::printConsoleL(const std::string& msg) {
         printConsoleExL(msg, 0);
     }
@@ -666,6 +1775,9 @@ namespace PLP {
         module.addConstant("ERROR", LineReaderResult::ERROR);
         module.addConstant("NOT_FOUND", LineReaderResult::NOT_FOUND);
         module.addConstant("SUCCESS", LineReaderResult::SUCCESS);
+        module.addConstant("READER_FSTREAM", PagedReaderType::PAGED_READER_FSTREAM);
+        module.addConstant("READER_MEMORY_MAPPED", PagedReaderType::PAGED_READER_MEMORY_MAPPED);
+        module.addConstant("READER_IO_URING", PagedReaderType::PAGED_READER_IO_URING);
 
         std::string(*stringTrimL)(const std::string&) = &stringTrim;
         module.addFunction("stringTrim", stringTrimL);
@@ -674,9 +1786,12 @@ namespace PLP {
 
         auto plpClass = module.beginClass<Core>("Core");
         plpClass.addFunction("createFileReader", &Core::createFileReaderL);
+        plpClass.addFunction("createFileReaderEx", &Core::createFileReaderExL);
         plpClass.addFunction("createFileWriter", &Core::createFileWriterL);
         plpClass.addFunction("createIndexReader", &Core::createIndexReaderL);
         plpClass.addFunction("createIndexWriter", &Core::createIndexWriterL);
+        plpClass.addFunction("createMemIndexWriter", &Core::createMemIndexWriterL);
+        plpClass.addFunction("releaseMemIndex", &Core::releaseMemIndex);
         plpClass.addFunction("releaseFileReader", &Core::releaseFileReaderL);
         plpClass.addFunction("releaseFileWriter", &Core::releaseFileWriterL);
         plpClass.addFunction("releaseIndexReader", &Core::releaseIndexReaderL);
@@ -685,9 +1800,20 @@ namespace PLP {
         plpClass.addFunction("searchI", &Core::searchIL);
         plpClass.addFunction("searchMultiline", &Core::searchMultilineL);
         plpClass.addFunction("searchMultilineI", &Core::searchMultilineIL);
+        plpClass.addFunction("searchSequence", &Core::searchSequenceL);
+        plpClass.addFunction("searchSequenceI", &Core::searchSequenceIL);
+        plpClass.addFunction("searchMany", &Core::searchManyL);
+        plpClass.addFunction("searchManyI", &Core::searchManyIL);
+        plpClass.addFunction("indexUnion", &Core::indexUnionL);
+        plpClass.addFunction("indexIntersection", &Core::indexIntersectionL);
+        plpClass.addFunction("indexDifference", &Core::indexDifferenceL);
+        plpClass.addFunction("count", &Core::countL);
+        plpClass.addFunction("countI", &Core::countIL);
         plpClass.addFunction("printConsole", &Core::printConsoleL);
         plpClass.addFunction("printConsoleEx", &Core::printConsoleExL);
         plpClass.addFunction("isCanceled", &Core::isCancelled);
+        plpClass.addFunction("setReadAheadDepth", &Core::setReadAheadDepth);
+        plpClass.addFunction("setSearchThreadCount", &Core::setSearchThreadCount);
         plpClass.endClass();
 
         {
@@ -715,6 +1841,8 @@ namespace PLP {
         auto resultReaderClass = module.beginClass<IndexReader>("IndexReader");
         std::tuple<bool, unsigned long long>(IndexReader::*nextResult)() = &IndexReader::nextResult;
         resultReaderClass.addFunction("nextIndex", nextResult);
+        std::vector<unsigned long long>(IndexReader::*nextResults)(unsigned long long) = &IndexReader::nextResults;
+        resultReaderClass.addFunction("nextIndexes", nextResults);
         resultReaderClass.addFunction("getLineNumber", &IndexReader::getLineNumber);
         resultReaderClass.addFunction("getNumIndexes", &IndexReader::getNumResults);
         resultReaderClass.addFunction("getFilePath", &IndexReader::getFilePath);
@@ -819,11 +1947,12 @@ namespace PLP {
         auto tcTextComparator = module.beginClass<TextComparator>("TextComparator");
         bool(TextComparator::*match)(const std::string&) = &TextComparator::match;
         tcTextComparator.addFunction("match", match);
+        tcTextComparator.addFunction("getStats", &TextComparator::getStats);
         tcTextComparator.endClass();
 
         auto tcMatchString = module.beginClass<MatchString>("MatchString");
-        tcMatchString.addFactory([](const std::string& text, bool exact) -> std::shared_ptr<TextComparator> {
-            std::shared_ptr<TextComparator> comparator(new MatchString(text, exact));
+        tcMatchString.addFactory([](const std::string& text, bool exact, bool ignoreCase) -> std::shared_ptr<TextComparator> {
+            std::shared_ptr<TextComparator> comparator(new MatchString(text, exact, ignoreCase));
             if (!comparator->initialize()) {
                 return nullptr;
             }
@@ -851,6 +1980,16 @@ namespace PLP {
         });
         tcMatchAny.endClass();
 
+        auto tcMatchAnyString = module.beginClass<MatchAnyString>("MatchAnyString");
+        tcMatchAnyString.addFactory([](const std::vector<std::string>& texts) -> std::shared_ptr<TextComparator> {
+            std::shared_ptr<TextComparator> comparator(new MatchAnyString(texts));
+            if (!comparator->initialize()) {
+                return nullptr;
+            }
+            return comparator;
+        });
+        tcMatchAnyString.endClass();
+
         auto tcMatchNot = module.beginClass<MatchNot>("MatchNot");
         tcMatchNot.addFactory([](std::shared_ptr<TextComparator> comparator) -> std::shared_ptr<TextComparator> {
             std::shared_ptr<TextComparator> notComparator(new MatchNot(comparator));
@@ -862,8 +2001,8 @@ namespace PLP {
         tcMatchNot.endClass();
 
         auto tcMatchRegex = module.beginClass<MatchRegex>("MatchRegex");
-        tcMatchRegex.addFactory([](const std::string& regexPattern)  -> std::shared_ptr<TextComparator> {
-            std::shared_ptr<TextComparator> comparator(new MatchRegex(regexPattern));
+        tcMatchRegex.addFactory([](const std::string& regexPattern, bool ignoreCase)  -> std::shared_ptr<TextComparator> {
+            std::shared_ptr<TextComparator> comparator(new MatchRegex(regexPattern, ignoreCase));
             if (!comparator->initialize()) {
                 return nullptr;
             }
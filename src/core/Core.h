@@ -25,6 +25,7 @@
 #include <memory>
 #include <vector>
 #include <atomic>
+#include <tuple>
 
 #define PLP_LIB_EXPORT __declspec(dllexport)
 #define PLP_LIB_IMPORT __declspec(dllimport)
@@ -37,8 +38,13 @@
 
 struct lua_State;
 
+namespace LC {
+    class ProgressReporter;
+}
+
 namespace PLP {
     class Thread;
+    class ThreadPool;
     class FileReader;
     class FileWriter;
     class IndexReader;
@@ -54,6 +60,8 @@ namespace PLP {
         bool runScript(const std::wstring* scriptLua) override;
         void cancelOperation() override;
         bool isCancelled() override;
+        void setReadAheadDepth(unsigned int numPages) override;
+        void setSearchThreadCount(unsigned int numThreads) override;
         
         bool attachLogOutput(const char* name, const std::function<void(int, const char*)>* func);
         void detachLogOutput(const char* name);
@@ -62,7 +70,8 @@ namespace PLP {
         FileReaderI* createFileReader(
             const std::string& path,
             unsigned long long preferredBuffSizeBytes,
-            const std::function<void(int percent)>* progressUpdate
+            const std::function<void(int percent)>* progressUpdate,
+            PagedReaderType readerType = PAGED_READER_FSTREAM
         ) override;
 
         FileWriterI* createFileWriter(
@@ -83,6 +92,16 @@ namespace PLP {
             bool overwriteIfExists
         ) override;
 
+        IndexWriterI* createMemIndexWriter(
+            const std::string& path,
+            unsigned long long preferredBuffSizeBytes,
+            unsigned long long memoryBudgetBytes,
+            const FileReaderI* fReader,
+            bool overwriteIfExists
+        ) override;
+
+        void releaseMemIndex(const std::string& path) override;
+
         void release(FileReaderI*) override;
         void release(FileWriterI*) override;
         void release(IndexReaderI*) override;
@@ -94,6 +113,12 @@ namespace PLP {
             unsigned long long preferredBuffSizeBytes
         );
 
+        std::shared_ptr<FileReader> createFileReaderExL(
+            const std::string& path,
+            unsigned long long preferredBuffSizeBytes,
+            int readerType
+        );
+
         std::shared_ptr<FileWriter> createFileWriterL(
             const std::string& path,
             unsigned long long preferredBuffSizeBytes,
@@ -112,6 +137,14 @@ namespace PLP {
             bool overwriteIfExists
         );
 
+        std::shared_ptr<IndexWriter> createMemIndexWriterL(
+            const std::string& path,
+            unsigned long long preferredBuffSizeBytes,
+            unsigned long long memoryBudgetBytes,
+            const std::shared_ptr<FileReader> fReader,
+            bool overwriteIfExists
+        );
+
         void releaseFileReaderL(std::shared_ptr<FileReader>& p);
         void releaseFileWriterL(std::shared_ptr<FileWriter>& p);
         void releaseIndexReaderL(std::shared_ptr<IndexReader>& p);
@@ -127,6 +160,28 @@ namespace PLP {
             const std::function<void(int percent)>* progressUpdate
         );
 
+        bool searchParallel(
+            FileReaderI* fileReader,
+            unsigned long long start,
+            unsigned long long end,
+            const std::vector<std::shared_ptr<TextComparator>>& comparators, // one per thread
+            const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& action,
+            LC::ProgressReporter& progressReporter
+        );
+
+        bool matchParallel(
+            FileReaderI* fileReader,
+            unsigned long long start,
+            unsigned long long end,
+            const std::vector<std::shared_ptr<TextComparator>>& comparators, // one per thread
+            const std::function<void(unsigned int slot)>& beginChunk,
+            const std::function<bool(unsigned int slot, unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& onMatch,
+            const std::function<bool(unsigned int slot, unsigned long long endLine)>& mergeChunk
+        );
+
+        // false if a clone failed to initialize, no clones if the comparator cannot be copied
+        bool cloneComparator(TextComparator* comparator, unsigned int numClones, std::vector<std::shared_ptr<TextComparator>>& clones);
+
         bool searchMultilineGeneral(
             FileReaderI* fileReader,
             IndexReaderI* indexReader,
@@ -137,6 +192,19 @@ namespace PLP {
             const std::function<void(int percent)>* progressUpdate
         );
 
+        bool searchSequenceGeneral(
+            FileReaderI* fileReader,
+            IndexReaderI* indexReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            const std::vector<TextComparator*>& steps,
+            const std::vector<unsigned long long>& maxGaps,
+            const std::vector<int>& keyWords,
+            bool lastStepAbsent,
+            const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)> action,
+            const std::function<void(int percent)>* progressUpdate
+        );
+
         bool search(
             FileReaderI* fileReader,
             IndexReaderI* indexReader,
@@ -159,6 +227,47 @@ namespace PLP {
             const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
         ) override;
 
+        bool searchSequence(
+            FileReaderI* fileReader,
+            IndexReaderI* indexReader,
+            IndexWriterI* indexWriter,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            unsigned long long maxNumResults,
+            const std::vector<TextComparator*>& steps,
+            const std::vector<unsigned long long>& maxGaps,
+            const std::vector<int>& keyWords,
+            bool lastStepAbsent,
+            const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+        ) override;
+
+        bool searchMany(
+            FileReaderI* fileReader,
+            IndexReaderI* indexReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            const std::vector<SearchQuery>& queries,
+            const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+        ) override;
+
+        bool mergeIndexes(
+            const std::vector<IndexReaderI*>& indexReaders,
+            IndexWriterI* indexWriter,
+            IndexSetOperation operation,
+            unsigned long long maxNumResults
+        ) override;
+
+        bool count(
+            FileReaderI* fileReader,
+            IndexReaderI* indexReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            TextComparator* comparator,
+            unsigned int numBuckets,
+            MatchCount& result,
+            const std::function<void(int percent, unsigned long long numMatches)>* progressUpdate
+        ) override;
+
         bool searchL(
             std::shared_ptr<FileReader> fileReader,
             std::shared_ptr<IndexWriter> indexWriter,
@@ -197,13 +306,105 @@ namespace PLP {
             const std::unordered_map<int, std::shared_ptr<TextComparator>>& lineComparators
         );
 
+        bool searchSequenceL(
+            std::shared_ptr<FileReader> fileReader,
+            std::shared_ptr<IndexWriter> indexWriter,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            unsigned long long maxNumResults,
+            const std::vector<std::shared_ptr<TextComparator>>& steps,
+            const std::vector<unsigned long long>& maxGaps,
+            const std::vector<int>& keyWords,
+            bool lastStepAbsent
+        );
+
+        bool searchSequenceIL(
+            std::shared_ptr<FileReader> fileReader,
+            std::shared_ptr<IndexReader> indexReader,
+            std::shared_ptr<IndexWriter> indexWriter,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            unsigned long long maxNumResults,
+            const std::vector<std::shared_ptr<TextComparator>>& steps,
+            const std::vector<unsigned long long>& maxGaps,
+            const std::vector<int>& keyWords,
+            bool lastStepAbsent
+        );
+
+        bool searchManyL(
+            std::shared_ptr<FileReader> fileReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            const std::vector<std::shared_ptr<TextComparator>>& comparators,
+            const std::vector<std::shared_ptr<IndexWriter>>& indexWriters,
+            const std::vector<unsigned long long>& maxNumResults
+        );
+
+        bool searchManyIL(
+            std::shared_ptr<FileReader> fileReader,
+            std::shared_ptr<IndexReader> indexReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            const std::vector<std::shared_ptr<TextComparator>>& comparators,
+            const std::vector<std::shared_ptr<IndexWriter>>& indexWriters,
+            const std::vector<unsigned long long>& maxNumResults
+        );
+
+        bool mergeIndexesL(
+            const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+            std::shared_ptr<IndexWriter> indexWriter,
+            IndexSetOperation operation,
+            unsigned long long maxNumResults
+        );
+
+        bool indexUnionL(
+            const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+            std::shared_ptr<IndexWriter> indexWriter,
+            unsigned long long maxNumResults
+        );
+
+        bool indexIntersectionL(
+            const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+            std::shared_ptr<IndexWriter> indexWriter,
+            unsigned long long maxNumResults
+        );
+
+        bool indexDifferenceL(
+            const std::vector<std::shared_ptr<IndexReader>>& indexReaders,
+            std::shared_ptr<IndexWriter> indexWriter,
+            unsigned long long maxNumResults
+        );
+
+        std::tuple<bool, unsigned long long, unsigned long long, unsigned long long, std::vector<unsigned long long>> countL(
+            std::shared_ptr<FileReader> fileReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            std::shared_ptr<TextComparator> comparator,
+            unsigned int numBuckets
+        );
+
+        std::tuple<bool, unsigned long long, unsigned long long, unsigned long long, std::vector<unsigned long long>> countIL(
+            std::shared_ptr<FileReader> fileReader,
+            std::shared_ptr<IndexReader> indexReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            std::shared_ptr<TextComparator> comparator,
+            unsigned int numBuckets
+        );
+
         void printConsoleL(const std::string& msg);
         void printConsoleExL(const std::string& msg, int level);
     private:
         static void attachLuaBindings(lua_State* state);
 
+        static const unsigned long long LITERAL_SCAN_STEP_NUM_LINES = 1000000;
+
         lua_State* _state;
         std::unique_ptr<Thread> _fileOpThread;
+        std::unique_ptr<Thread> _readAheadThread;
+        std::unique_ptr<ThreadPool> _workerPool;
+        unsigned int _readAheadDepth = 2;
+        unsigned int _searchThreadCount = 0;
         std::atomic<bool> _cancelled = false;
         bool _cleanupGeneratedFiles = false;
     };
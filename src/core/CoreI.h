@@ -18,17 +18,25 @@
 #pragma once
 
 #include "TextComparator.h"
+#include "FileReaderI.h"
+#include "MatchCount.h"
+#include "IndexMerger.h"
 
 #include <string>
 #include <functional>
 #include <vector>
 
 namespace PLP {
-    class FileReaderI;
     class FileWriterI;
     class IndexReaderI;
     class IndexWriterI;
 
+    struct SearchQuery {
+        TextComparator* comparator;
+        IndexWriterI* indexWriter;
+        unsigned long long maxNumResults; //0 for no limit
+    };
+
     class CoreI {
     public:
         virtual ~CoreI() {}
@@ -38,13 +46,16 @@ namespace PLP {
         virtual bool runScript(const std::wstring* scriptLua) = 0;
         virtual void cancelOperation() = 0;
         virtual bool isCancelled() = 0;
+        virtual void setReadAheadDepth(unsigned int numPages) = 0;
+        virtual void setSearchThreadCount(unsigned int numThreads) = 0; //0 to use all cores, 1 to search on the calling thread
         virtual bool attachLogOutput(const char* name, const std::function<void(int, const char*)>* func) = 0;
         virtual void detachLogOutput(const char* name) = 0;
 
         virtual FileReaderI* createFileReader(
             const std::string& path,
             unsigned long long preferredBuffSizeBytes,
-            const std::function<void(int percent)>* progressUpdate
+            const std::function<void(int percent)>* progressUpdate,
+            PagedReaderType readerType = PAGED_READER_FSTREAM
         ) = 0;
 
         virtual FileWriterI* createFileWriter(
@@ -65,6 +76,19 @@ namespace PLP {
             bool overwriteIfExists
         ) = 0;
 
+        // Keeps the index in memory until it outgrows memoryBudgetBytes (0 for no limit), after which it is written to path.
+        // createIndexReader opens it by the same path
+        virtual IndexWriterI* createMemIndexWriter(
+            const std::string& path,
+            unsigned long long preferredBuffSizeBytes,
+            unsigned long long memoryBudgetBytes,
+            const FileReaderI* fReader,
+            bool overwriteIfExists
+        ) = 0;
+
+        // Frees an index kept in memory by createMemIndexWriter
+        virtual void releaseMemIndex(const std::string& path) = 0;
+
         virtual void release(FileReaderI*) = 0;
         virtual void release(FileWriterI*) = 0;
         virtual void release(IndexReaderI*) = 0;
@@ -91,5 +115,50 @@ namespace PLP {
             const std::unordered_map<int, TextComparator*>& lineComparators,
             const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
         ) = 0;
+
+        // Runs several searches over a single pass of the file, each one stops on its own maxNumResults
+        virtual bool searchMany(
+            FileReaderI* fileReader,
+            IndexReaderI* indexReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            const std::vector<SearchQuery>& queries,
+            const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+        ) = 0;
+
+        // Combines indexes of the same file without reading it, see IndexMerger
+        virtual bool mergeIndexes(
+            const std::vector<IndexReaderI*>& indexReaders,
+            IndexWriterI* indexWriter,
+            IndexSetOperation operation,
+            unsigned long long maxNumResults
+        ) = 0;
+
+        // Counts the matching lines without writing an index
+        virtual bool count(
+            FileReaderI* fileReader,
+            IndexReaderI* indexReader,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            TextComparator* comparator,
+            unsigned int numBuckets, //0 for no histogram
+            MatchCount& result,
+            const std::function<void(int percent, unsigned long long numMatches)>* progressUpdate
+        ) = 0;
+
+        // Finds the first lines of sequences of steps, see SequenceMatcher
+        virtual bool searchSequence(
+            FileReaderI* fileReader,
+            IndexReaderI* indexReader,
+            IndexWriterI* indexWriter,
+            unsigned long long start,
+            unsigned long long end, //0 for end of file, inclusive
+            unsigned long long maxNumResults,
+            const std::vector<TextComparator*>& steps,
+            const std::vector<unsigned long long>& maxGaps,
+            const std::vector<int>& keyWords,
+            bool lastStepAbsent,
+            const std::function<void(int percent, unsigned long long numResults)>* progressUpdate
+        ) = 0;
     };
 }
\ No newline at end of file
@@ -19,25 +19,39 @@
 
 #include "Utils.h"
 
+#include <algorithm>
+
 namespace PLP {
     FStreamPagedReader::FStreamPagedReader() {}
     FStreamPagedReader::~FStreamPagedReader() {
+        waitForPendingLoads();
         _ifs.close();
+        _readAheadIfs.close();
     }
 
-    bool FStreamPagedReader::initialize(const std::wstring& path, unsigned long long preferredBuffSize/*, TaskRunner& asyncTaskRunner*/) {
+    bool FStreamPagedReader::initialize(
+        const std::wstring& path, 
+        unsigned long long preferredBuffSize, 
+        TaskRunner* asyncTaskRunner, 
+        unsigned int readAheadDepth
+    ) {
         _filePath = path;
-        //_asyncTaskRunner = &asyncTaskRunner;
+        _asyncTaskRunner = asyncTaskRunner;
 
-        unsigned long long buffSize;
         if (preferredBuffSize < OPTIMAL_BLOCK_SIZE_BYTES) {
-            buffSize = OPTIMAL_BLOCK_SIZE_BYTES;
+            _pageSizeBytes = OPTIMAL_BLOCK_SIZE_BYTES;
         } else {
-            buffSize = preferredBuffSize / OPTIMAL_BLOCK_SIZE_BYTES * OPTIMAL_BLOCK_SIZE_BYTES;
+            _pageSizeBytes = preferredBuffSize / OPTIMAL_BLOCK_SIZE_BYTES * OPTIMAL_BLOCK_SIZE_BYTES;
         }
 
+        // one page is handed out to the caller while the rest are being preloaded
+        const unsigned int numPages = _asyncTaskRunner ? readAheadDepth + 1 : 1;
         try {
-            _buffer.resize(buffSize);
+            for (unsigned int i = 0; i < numPages; i++) {
+                std::unique_ptr<Page> page(new Page());
+                page->buffer.resize(_pageSizeBytes);
+                _pages.push_back(std::move(page));
+            }
         } catch (std::bad_alloc&) {
             return false;
         }
@@ -51,59 +65,13 @@ namespace PLP {
         _fileSize = _ifs.tellg();
         _ifs.seekg(0, _ifs.beg);
 
-        //buffer size must be a multiple of (OPTIMAL_BLOCK_SIZE_BYTES * 2) for efficiency
-        /*unsigned long long buffSize = buffer.size();
-        if (buffSize == 0 || (buffSize > 0 && buffSize % (OPTIMAL_BLOCK_SIZE_BYTES * 2) != 0)) {
-            return false;
-        }
-
-        _ifs.open(path, std::ifstream::in | std::ifstream::binary);
-        if (!_ifs.good()) {
-            return false;
-        }
-
-        _ifs.seekg(0, _ifs.end);
-        _fileSize = _ifs.tellg();
-        _ifs.seekg(0, _ifs.beg);
-
-        _pageSizeBytes = buffer.size() / 2;
-        _backBuff = &buffer[0];
-        _frontBuff = &buffer[0] + _pageSizeBytes;
-
-        _preloadNextPage = [&]() {
-            _currentPageLD.backtracked = false;
-
-            unsigned long long fileOffset = _lastPageLD.fileOffsetBytes + _lastPageLD.buffStartOffsetBytes + _lastPageLD.buffSizeBytes;
-            unsigned long long bytesTillEnd = _fileSize - fileOffset;
-            if (0 == bytesTillEnd) {
-                _currentPageLD.endOfFile = true;
-                return;
+        if (_pages.size() > 1) {
+            _readAheadIfs.open(path, std::ifstream::in | std::ifstream::binary);
+            if (!_readAheadIfs.good()) {
+                return false;
             }
-            
-            unsigned long long bytesToRead = bytesTillEnd > _pageSizeBytes ? _pageSizeBytes : bytesTillEnd;
-
-            _ifs.seekg(fileOffset);
-            _ifs.read(_backBuff, bytesToRead);
-            if (!_ifs.good()) {
-                _currentPageLD.readErrorOccurred = true;
-                return;
-            }
-
-            const char* lastLineEnd = findLastLineEnding(_backBuff, bytesToRead, _backBuff + bytesToRead - 1);
-            unsigned long long usefulBytesRead = 0;
-            if (lastLineEnd) {
-                usefulBytesRead = lastLineEnd - _backBuff + 1;
-            }
-
-            _currentPageLD.fileOffsetBytes = fileOffset;
-            _currentPageLD.buffStartOffsetBytes = 0;
-            _currentPageLD.buffSizeBytes = usefulBytesRead;
-            //_currentPageLD.buffSizeBytes = bytesToRead;
-            _currentPageLD.endOfFile = bytesTillEnd <= _pageSizeBytes ? true : false;
-        };
+        }
 
-        //start preloading next page
-        _asyncTaskRunner->runAsync(_preloadNextPage, _currPageLoadStatus);*/
         return true;
     }
 
@@ -113,76 +81,141 @@ namespace PLP {
             return nullptr;
         }
 
-        const unsigned long long bytesTillEnd = _fileSize - fileOffset;
-        const unsigned long long bytesToRead = bytesTillEnd > _buffer.size() ? _buffer.size() : bytesTillEnd;
-        if (bytesToRead == 0) {
-            return nullptr;
-        }
+        const bool sequential = fileOffset == _nextSequentialOffset;
 
-        _ifs.seekg(fileOffset);
-        _ifs.read(_buffer.data(), bytesToRead);
-        if (!_ifs.good()) {
-            return nullptr;
+        Page* page = findPage(fileOffset);
+        if (page) {
+            waitForLoad(*page);
+            if (!page->loaded) { // the load failed or was cancelled, read the page again from this thread
+                page->valid = false;
+                page = nullptr;
+            }
         }
 
-        size = bytesToRead;
-        return _buffer.data();
-    }
-
-    /*const char* FStreamPagedReader::getNextPage(unsigned long long& size) {
-        if (!_lastPageLD.backtracked && (_lastPageLD.endOfFile || _lastPageLD.readErrorOccurred)) {
-            size = 0;
-            return nullptr;
+        if (!page) {
+            // nothing preloaded for this offset (first read or random access). Loads in flight are left to finish
+            // on their own stream, the page is read into one that is not loading
+            page = findIdlePage();
+            if (!loadPage(*page, fileOffset)) {
+                page->valid = false;
+                return nullptr;
+            }
         }
+        _nextSequentialOffset = page->fileOffset + page->size;
 
-        timer.deltaT();
-        while (!_currPageLoadStatus.isCompleted()) {
-            //printf("Waiting for next page\n"); //TODO: remove and add a timer to measure this window
+        if (sequential && _pages.size() > 1) {
+            scheduleReadAhead(*page);
         }
-        double numSeconds = timer.deltaT() / 1000000000;
-        printf("Waited for page %f seconds\n", numSeconds);
 
-        //swap buffers
-        char* temp = _frontBuff;
-        _frontBuff = _backBuff;
-        _backBuff = temp;
+        const unsigned long long deltaOffset = fileOffset - page->fileOffset;
+        size = page->size - deltaOffset;
+        return page->buffer.data() + deltaOffset;
+    }
 
-        //move current loading info to last, and reset current
-        _lastPageLD = _currentPageLD;
-        _currentPageLD = LoadingData();
+    bool FStreamPagedReader::loadPage(Page& page, unsigned long long fileOffset) {
+        const unsigned long long bytesTillEnd = _fileSize - fileOffset;
+        const unsigned long long bytesToRead = bytesTillEnd > _pageSizeBytes ? _pageSizeBytes : bytesTillEnd;
 
-        //reset loading status
-        _currPageLoadStatus = TaskStatus();
+        page.fileOffset = fileOffset;
+        page.size = bytesToRead;
+        page.valid = true;
+        page.loaded = readPage(_ifs, page.buffer.data(), fileOffset, bytesToRead);
+        return page.loaded;
+    }
 
-        if (_lastPageLD.readErrorOccurred) {
-            size = 0;
-            return nullptr;
+    bool FStreamPagedReader::readPage(std::ifstream& ifs, char* buffer, unsigned long long fileOffset, unsigned long long size) {
+        ifs.seekg(fileOffset);
+        ifs.read(buffer, size);
+        if (!ifs.good()) {
+            ifs.clear();
+            return false;
         }
+        return true;
+    }
 
-        //start preloading next page
-        _asyncTaskRunner->runAsync(_preloadNextPage, _currPageLoadStatus);
-
-        size = _lastPageLD.buffSizeBytes;
-        return _frontBuff + _lastPageLD.buffStartOffsetBytes;
-
+    FStreamPagedReader::Page* FStreamPagedReader::findPage(unsigned long long fileOffset) {
+        for (auto& page : _pages) {
+            if (page->valid && fileOffset >= page->fileOffset && fileOffset < page->fileOffset + page->size) {
+                return page.get();
+            }
+        }
         return nullptr;
     }
-    
-     unsigned long long FStreamPagedReader::getCurrentPageFileOffset() {
-        return _currentPageLD.fileOffsetBytes + _currentPageLD.buffStartOffsetBytes;
+
+    FStreamPagedReader::Page* FStreamPagedReader::findIdlePage() {
+        // read-ahead keeps at most every page but the current one loading, so an idle page is always left
+        Page* idlePage = nullptr;
+        for (auto& page : _pages) {
+            if (page->loadStatus.isCompleted()) {
+                if (!page->valid) {
+                    return page.get();
+                }
+                if (!idlePage) {
+                    idlePage = page.get();
+                }
+            }
+        }
+        return idlePage;
     }
 
-    void FStreamPagedReader::resetToBeginning() {
-        while (!_currPageLoadStatus.isCompleted()) {
+    void FStreamPagedReader::scheduleReadAhead(Page& currPage) {
+        // pages that continue the chain starting at the current page are kept, everything else is recycled
+        std::vector<Page*> chain;
+        chain.push_back(&currPage);
+
+        unsigned long long nextFileOffset = currPage.fileOffset + currPage.size;
+        while (chain.size() < _pages.size() && nextFileOffset < _fileSize) {
+            Page* nextPage = nullptr;
+            for (auto& page : _pages) {
+                if (page->valid && page->fileOffset == nextFileOffset) {
+                    nextPage = page.get();
+                    break;
+                }
+            }
+
+            if (!nextPage) {
+                for (auto& page : _pages) {
+                    if (std::find(chain.begin(), chain.end(), page.get()) == chain.end() && page->loadStatus.isCompleted()) {
+                        nextPage = page.get();
+                        break;
+                    }
+                }
+                if (!nextPage) { // recycled page is still loading, try again on the next read
+                    return;
+                }
+
+                const unsigned long long bytesTillEnd = _fileSize - nextFileOffset;
+                nextPage->fileOffset = nextFileOffset;
+                nextPage->size = bytesTillEnd > _pageSizeBytes ? _pageSizeBytes : bytesTillEnd;
+                nextPage->valid = true;
+                nextPage->loaded = false;
+                nextPage->loadStatus = TaskStatus();
+
+                char* buffer = nextPage->buffer.data();
+                bool* loaded = &nextPage->loaded;
+                const unsigned long long fileOffset = nextPage->fileOffset;
+                const unsigned long long size = nextPage->size;
+                _asyncTaskRunner->runAsync([this, buffer, loaded, fileOffset, size]() {
+                    *loaded = readPage(_readAheadIfs, buffer, fileOffset, size);
+                }, nextPage->loadStatus);
+            }
+
+            chain.push_back(nextPage);
+            nextFileOffset = nextPage->fileOffset + nextPage->size;
         }
+    }
 
-        _currentPageLD = LoadingData();
-        _lastPageLD = LoadingData();
-        _currPageLoadStatus = TaskStatus();
+    void FStreamPagedReader::waitForLoad(Page& page) {
+        if (_asyncTaskRunner) {
+            _asyncTaskRunner->wait(page.loadStatus);
+        }
+    }
 
-        _asyncTaskRunner->runAsync(_preloadNextPage, _currPageLoadStatus);
+    void FStreamPagedReader::waitForPendingLoads() {
+        for (auto& page : _pages) {
+            waitForLoad(*page);
+        }
     }
-    */
 
     unsigned long long FStreamPagedReader::getFileSize() {
         return _fileSize;
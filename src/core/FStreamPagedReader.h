@@ -19,12 +19,11 @@
 
 #include "PagedReader.h"
 #include "TaskRunner.h"
-#include "Timer.h"
 
 #include <string>
 #include <vector>
 #include <fstream>
-#include <functional>
+#include <memory>
 
 namespace PLP {
     class TaskRunner;
@@ -34,47 +33,47 @@ namespace PLP {
         FStreamPagedReader();
         ~FStreamPagedReader();
 
-        bool initialize(const std::wstring& path, unsigned long long preferredBuffSize/*, TaskRunner& asyncTaskRunner*/);
+        // readAheadDepth is the number of pages loaded in the background ahead of the last page read, scheduled only
+        // while reads are sequential. Read-ahead requires asyncTaskRunner, which has to run the loads one at a time
+        // (they share a stream), and is disabled when readAheadDepth is 0
+        bool initialize(
+            const std::wstring& path, 
+            unsigned long long preferredBuffSize, 
+            TaskRunner* asyncTaskRunner = nullptr, 
+            unsigned int readAheadDepth = 0
+        );
         const char* read(unsigned long long fileOffset, unsigned long long& size) override;
         unsigned long long getFileSize() override;
         const std::wstring& getFilePath() override;
-        
-        /*const char* getNextPage(unsigned long long& size);
-        void resetToBeginning();
-        unsigned long long getCurrentPageFileOffset();*/
-    private:
-        
-        std::wstring _filePath;
-        std::vector<char> _buffer;
-        TaskRunner* _asyncTaskRunner;
-        
-        std::ifstream _ifs;
-        unsigned long long _fileSize;
 
-        /*struct LoadingData {
-            unsigned long long fileOffsetBytes = 0;
-            unsigned long long buffStartOffsetBytes = 0;
-            unsigned long long buffSizeBytes = 0;
-            bool backtracked = false;
-            bool endOfFile = false;
-            bool readErrorOccurred = false;
+    private:
+        // fileOffset, size and valid belong to the reading thread. A background load only fills the buffer
+        // and sets loaded, which is read after loadStatus is completed
+        struct Page {
+            std::vector<char> buffer;
+            unsigned long long fileOffset = 0;
+            unsigned long long size = 0;
+            bool valid = false; // page is loaded or loading
+            bool loaded = false;
+            TaskStatus loadStatus;
         };
 
-        Timer timer;
-        
-        
-        
-        
+        bool loadPage(Page& page, unsigned long long fileOffset);
+        bool readPage(std::ifstream& ifs, char* buffer, unsigned long long fileOffset, unsigned long long size);
+        Page* findPage(unsigned long long fileOffset);
+        Page* findIdlePage();
+        void scheduleReadAhead(Page& currPage);
+        void waitForLoad(Page& page);
+        void waitForPendingLoads();
 
-        unsigned long long _pageSizeBytes;
-        char* _frontBuff;
-        char* _backBuff;
+        std::wstring _filePath;
+        std::vector<std::unique_ptr<Page>> _pages;
+        TaskRunner* _asyncTaskRunner = nullptr;
         
-        LoadingData _currentPageLD;
-        LoadingData _lastPageLD;
-        TaskStatus _currPageLoadStatus;
-
-        std::function<void()> _preloadNextPage;
-        std::function<void()> _preloadPreviousPage;*/
+        std::ifstream _ifs;
+        std::ifstream _readAheadIfs; // used by the background loads only
+        unsigned long long _fileSize = 0;
+        unsigned long long _pageSizeBytes = 0;
+        unsigned long long _nextSequentialOffset = 0;
     };
 }
\ No newline at end of file
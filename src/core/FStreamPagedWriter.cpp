@@ -89,7 +89,7 @@ namespace PLP {
             }
 
             if (_frontBuffContentSize == _pageSizeBytes) {
-                while (!_backBuffLoadStatus.isCompleted()) {} // wait for the back buffer to save
+                _asyncTaskRunner->wait(_backBuffLoadStatus); // wait for the back buffer to save
 
                 swapBuffers();
 
@@ -111,7 +111,7 @@ namespace PLP {
         }
 
         if (_frontBuffContentSize > 0) {
-            while (!_backBuffLoadStatus.isCompleted()) {} // wait for the back buffer to save
+            _asyncTaskRunner->wait(_backBuffLoadStatus); // wait for the back buffer to save
             _backBuffLoadStatus = TaskStatus();
             
             _ofs.write(_frontBuff, _frontBuffContentSize);
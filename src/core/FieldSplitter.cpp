@@ -0,0 +1,184 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "FieldSplitter.h"
+#include "ByteSearch.h"
+
+#include <cstring>
+#include <climits>
+
+namespace PLP {
+    bool FieldSplitter::initializeDelimiter(const std::string& delimiter) {
+        if (delimiter.empty()) {
+            return false;
+        }
+
+        _delimiter = delimiter;
+        _words = false;
+
+        // a delimiter that can overlap itself, like "aa", may be found at different places when searching from
+        // the end. Those lines are split from the start instead
+        _lastFromFirst = false;
+        for (size_t border = 1; border < delimiter.size(); border++) {
+            if (memcmp(delimiter.data(), delimiter.data() + delimiter.size() - border, border) == 0) {
+                _lastFromFirst = true;
+                break;
+            }
+        }
+        return _searcher.initialize(delimiter);
+    }
+
+    void FieldSplitter::initializeWords() {
+        _words = true;
+        _lastFromFirst = false;
+    }
+
+    bool FieldSplitter::split(const char* data, unsigned int size, unsigned int numFirst, unsigned int numLast) {
+        _first.clear();
+        _last.clear();
+
+        if (numLast > 0 && _lastFromFirst) {
+            splitFirst(data, size, UINT_MAX);
+            return _first.size() >= numFirst && _first.size() >= numLast;
+        }
+        if (numFirst > 0) {
+            splitFirst(data, size, numFirst);
+            if (_first.size() < numFirst) {
+                return false;
+            }
+        }
+        if (numLast > 0) {
+            splitLast(data, size, numLast);
+            if (_last.size() < numLast) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const FieldSplitter::Field& FieldSplitter::getField(int index) const {
+        if (index >= 0) {
+            return _first[index];
+        }
+        if (_lastFromFirst) {
+            return _first[_first.size() + index];
+        }
+        return _last[-index - 1];
+    }
+
+    void FieldSplitter::splitFirst(const char* data, unsigned int size, unsigned int maxNumFields) {
+        const char* end = data + size;
+        if (_words) {
+            const char* pos = data;
+            while (_first.size() < maxNumFields) {
+                const char* wordStart = findNonSpace(pos, end);
+                pos = findSpace(wordStart, end);
+                if (pos == end) {
+                    break;
+                }
+                _first.emplace_back(wordStart, (unsigned int)(pos - wordStart));
+            }
+            return;
+        }
+
+        const unsigned int delimiterSize = (unsigned int)_delimiter.size();
+        const char* fieldStart = data;
+        while (_first.size() < maxNumFields) {
+            const char* found = _searcher.find(fieldStart, (unsigned int)(end - fieldStart));
+            if (!found) {
+                break;
+            }
+            const char* fieldEnd = found + delimiterSize;
+            _first.emplace_back(fieldStart, (unsigned int)(fieldEnd - fieldStart));
+            fieldStart = fieldEnd;
+        }
+        if (_first.size() >= maxNumFields) {
+            return;
+        }
+
+        const unsigned int remaining = (unsigned int)(end - fieldStart);
+        if (size == 0 || remaining >= 2) {
+            _first.emplace_back(fieldStart, remaining);
+        } else if (_first.empty()) {
+            _first.emplace_back(data, 0);
+        }
+    }
+
+    void FieldSplitter::splitLast(const char* data, unsigned int size, unsigned int maxNumFields) {
+        const char* end = data + size;
+        if (_words) {
+            const char* pos = end;
+            while (pos > data && !isSpaceByte(*(pos - 1))) { // not followed by whitespace
+                pos--;
+            }
+            while (_last.size() < maxNumFields) {
+                while (pos > data && isSpaceByte(*(pos - 1))) {
+                    pos--;
+                }
+                if (pos == data) {
+                    break;
+                }
+                const char* wordEnd = pos;
+                while (pos > data && !isSpaceByte(*(pos - 1))) {
+                    pos--;
+                }
+                _last.emplace_back(pos, (unsigned int)(wordEnd - pos));
+            }
+            return;
+        }
+
+        const unsigned int delimiterSize = (unsigned int)_delimiter.size();
+        const char* found = findLastDelimiter(data, end);
+        if (!found) {
+            _last.emplace_back(data, (size == 0 || size >= 2) ? size : 0);
+            return;
+        }
+
+        const char* fieldEnd = found + delimiterSize;
+        if (end - fieldEnd >= 2) {
+            _last.emplace_back(fieldEnd, (unsigned int)(end - fieldEnd));
+        }
+        while (_last.size() < maxNumFields) {
+            const char* previous = findLastDelimiter(data, found);
+            const char* fieldStart = previous ? previous + delimiterSize : data;
+            _last.emplace_back(fieldStart, (unsigned int)(fieldEnd - fieldStart));
+            if (!previous) {
+                break;
+            }
+            found = previous;
+            fieldEnd = fieldStart;
+        }
+    }
+
+    const char* FieldSplitter::findLastDelimiter(const char* begin, const char* end) const {
+        const unsigned int delimiterSize = (unsigned int)_delimiter.size();
+        const char lastByte = _delimiter.back();
+        const char* searchEnd = end;
+        while (searchEnd - begin >= (long long)delimiterSize) {
+            const char* pos = findLastByte(begin + delimiterSize - 1, searchEnd, lastByte);
+            if (pos == searchEnd) {
+                return nullptr;
+            }
+            const char* candidate = pos - delimiterSize + 1;
+            if (memcmp(candidate, _delimiter.data(), delimiterSize) == 0) {
+                return candidate;
+            }
+            searchEnd = pos;
+        }
+        return nullptr;
+    }
+}
@@ -0,0 +1,59 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "LiteralSearcher.h"
+
+#include <string>
+#include <vector>
+#include <utility>
+
+namespace PLP {
+    // Splits lines into fields in place. Only the fields that are asked for are located: the first ones by
+    // scanning forward and the last ones by scanning back from the end of the line
+    class FieldSplitter {
+    public:
+        typedef std::pair<const char*, unsigned int> Field;
+
+        // Splits on a delimiter the way MatchSubstrings does: every field keeps the delimiter that ends it, a single
+        // trailing byte after the last delimiter is not a field and a line without fields has one empty field
+        bool initializeDelimiter(const std::string& delimiter);
+
+        // Splits into words the way splitIntoWords does, which only counts words that are followed by whitespace
+        void initializeWords();
+
+        // Locates fields [0, numFirst) and the last numLast fields. Returns false if the line has too few fields for
+        // either, which is numFirst or numLast fields or fewer
+        bool split(const char* data, unsigned int size, unsigned int numFirst, unsigned int numLast);
+
+        // Index within the bounds of the last split, negative indexes count from the end of the line
+        const Field& getField(int index) const;
+
+    private:
+        void splitFirst(const char* data, unsigned int size, unsigned int maxNumFields);
+        void splitLast(const char* data, unsigned int size, unsigned int maxNumFields);
+        const char* findLastDelimiter(const char* begin, const char* end) const;
+
+        std::string _delimiter;
+        LiteralSearcher _searcher;
+        bool _words = false;
+        bool _lastFromFirst = false; // the last fields come from a full forward split
+        std::vector<Field> _first;
+        std::vector<Field> _last; // from the end of the line
+    };
+}
@@ -23,6 +23,7 @@
 #include "Utils.h"
 #include "IndexReader.h"
 #include "FStreamPagedReader.h"
+#include "IoUringPagedReader.h"
 #include "Logger.h"
 
 namespace PLP {
@@ -35,6 +36,10 @@ namespace PLP {
     bool FileReader::initialize(
         const std::wstring& path, 
         unsigned long long preferredBuffSizeBytes, 
+        PagedReaderType readerType,
+        TaskRunner* readAheadRunner,
+        unsigned int readAheadDepth,
+        ThreadPool* workerPool,
         const std::atomic<bool>& cancelled,
         const std::function<void(int percent)>* progressUpdate
     ) {
@@ -47,22 +52,82 @@ namespace PLP {
             return false;
         }
 
-        FStreamPagedReader* pagedReader = new FStreamPagedReader();
-        _pager.reset(pagedReader);
-        if (!pagedReader->initialize(unixPath, preferredBuffSizeBytes)) {
+        if (!createPager(unixPath, preferredBuffSizeBytes, readerType, readAheadRunner, readAheadDepth)) {
             return false;
         }
 
         IndexedLineReader* idxLineReader = new IndexedLineReader();
         _lineReader.reset(idxLineReader);
-        if (!idxLineReader->initialize(*_pager, 100000, cancelled, progressUpdate)) {
+        if (!idxLineReader->initialize(*_pager, MAX_LINE_SIZE_BYTES, workerPool, cancelled, progressUpdate)) {
             return false;
         }
 
+        _preferredBuffSizeBytes = preferredBuffSizeBytes;
+        _readerType = readerType;
+        _readAheadDepth = readAheadDepth;
         _readingLock = std::move(readingLock);
         return true;
     }
 
+    bool FileReader::createPager(
+        const std::wstring& path,
+        unsigned long long preferredBuffSizeBytes,
+        PagedReaderType readerType,
+        TaskRunner* readAheadRunner,
+        unsigned int readAheadDepth
+    ) {
+        if (readerType == PAGED_READER_MEMORY_MAPPED) {
+            MemMappedPagedReader* pagedReader = new MemMappedPagedReader();
+            _pager.reset(pagedReader);
+            if (!pagedReader->initialize(path, preferredBuffSizeBytes)) {
+                Logger::send(ERR, "Failed to memory map file " + wstring_to_string(path));
+                return false;
+            }
+        } else {
+            if (readerType == PAGED_READER_IO_URING) {
+                IoUringPagedReader* pagedReader = new IoUringPagedReader();
+                _pager.reset(pagedReader);
+                if (!pagedReader->initialize(path, preferredBuffSizeBytes, readAheadDepth)) {
+                    Logger::send(WARN, "io_uring is not available, falling back to stream reader for file " + wstring_to_string(path));
+                    _pager = nullptr;
+                }
+            }
+
+            if (!_pager) {
+                FStreamPagedReader* pagedReader = new FStreamPagedReader();
+                _pager.reset(pagedReader);
+                if (!pagedReader->initialize(path, preferredBuffSizeBytes, readAheadRunner, readAheadDepth)) {
+                    return false;
+                }
+            }
+        }
+        return true;
+    }
+
+    FileReaderI* FileReader::clone() {
+        if (!_lineReader) {
+            return nullptr;
+        }
+
+        // the read lock stays with this reader. Clones are used from worker threads so they don't share
+        // the read-ahead thread, stream readers read synchronously
+        std::unique_ptr<FileReader> reader(new FileReader());
+        if (!reader->createPager(_pager->getFilePath(), _preferredBuffSizeBytes, _readerType, nullptr, _readAheadDepth)) {
+            return nullptr;
+        }
+
+        IndexedLineReader* idxLineReader = new IndexedLineReader();
+        reader->_lineReader.reset(idxLineReader);
+        if (!idxLineReader->initialize(*reader->_pager, MAX_LINE_SIZE_BYTES, *_lineReader)) {
+            return nullptr;
+        }
+
+        reader->_preferredBuffSizeBytes = _preferredBuffSizeBytes;
+        reader->_readerType = _readerType;
+        reader->_readAheadDepth = _readAheadDepth;
+        return reader.release();
+    }
+
     void FileReader::release() {
         _lineReader = nullptr;
         _pager = nullptr;
@@ -72,6 +137,10 @@ namespace PLP {
         return _lineReader->nextLine(lineStart, length);
     }
 
+    LineReaderResult FileReader::nextLineContaining(const LiteralSearcher& literal, unsigned long long maxLineNumber, char*& lineStart, unsigned int& length) {
+        return _lineReader->nextLineContaining(literal, maxLineNumber, lineStart, length);
+    }
+
     std::tuple<int, std::string> FileReader::nextLine() {
         char* lineStart = nullptr;
         unsigned int length = 0;
@@ -94,6 +163,18 @@ namespace PLP {
         return _lineReader->getLineUnverified(rsReader->getLineNumber(), rsReader->getLineFileOffset(), data, size);
     }
 
+    LineReaderResult FileReader::getLineAtOffset(unsigned long long lineNumber, unsigned long long fileOffset, char*& data, unsigned int& size) {
+        return _lineReader->getLineUnverified(lineNumber, fileOffset, data, size);
+    }
+
+    void FileReader::prefetchLine(unsigned long long fileOffset) {
+        _pager->prefetch(fileOffset);
+    }
+
+    void FileReader::setPageReleaseCallback(const std::function<void()>* callback) {
+        _lineReader->setPageReleaseCallback(callback);
+    }
+
     std::tuple<int, std::string> FileReader::getLineFromResult(const std::shared_ptr<IndexReader> rsReader) {
         char* lineStart = nullptr;
         unsigned int length = 0;
@@ -29,6 +29,8 @@ namespace PLP {
     class PagedReader;
     class IndexedLineReader;
     class IndexReader;
+    class TaskRunner;
+    class ThreadPool;
 
     class FileReader : public FileReaderI{
     public:
@@ -38,16 +40,25 @@ namespace PLP {
         bool initialize(
             const std::wstring& path, 
             unsigned long long preferredBuffSizeBytes,
+            PagedReaderType readerType,
+            TaskRunner* readAheadRunner,
+            unsigned int readAheadDepth,
+            ThreadPool* workerPool,
             const std::atomic<bool>& cancelled,
             const std::function<void(int percent)>* progressUpdate
         );
         
         //C++ interface
         LineReaderResult nextLine(char*& lineStart, unsigned int& length) override;
+        LineReaderResult nextLineContaining(const LiteralSearcher& literal, unsigned long long maxLineNumber, char*& lineStart, unsigned int& length) override;
         LineReaderResult getLine(unsigned long long lineNumber, char*& data, unsigned int& size) override;
         LineReaderResult getLineFromResult(const IndexReaderI* rsReader, char*& data, unsigned int& size) override;
+        LineReaderResult getLineAtOffset(unsigned long long lineNumber, unsigned long long fileOffset, char*& data, unsigned int& size) override;
+        void prefetchLine(unsigned long long fileOffset) override;
+        void setPageReleaseCallback(const std::function<void()>* callback) override;
         unsigned long long getLineFileOffset() const override;
         const wchar_t* getFilePath() const override;
+        FileReaderI* clone() override;
 
         //Lua interface
         std::tuple<int, std::string> nextLine();
@@ -61,8 +72,21 @@ namespace PLP {
         void release() override;
 
     private:
+        bool createPager(
+            const std::wstring& path,
+            unsigned long long preferredBuffSizeBytes,
+            PagedReaderType readerType,
+            TaskRunner* readAheadRunner,
+            unsigned int readAheadDepth
+        );
+
+        static const unsigned int MAX_LINE_SIZE_BYTES = 100000;
+
         std::unique_ptr<PagedReader> _pager = nullptr;
         std::unique_ptr<IndexedLineReader> _lineReader = nullptr;
         FileScopedLock _readingLock;
+        unsigned long long _preferredBuffSizeBytes = 0;
+        PagedReaderType _readerType = PAGED_READER_FSTREAM;
+        unsigned int _readAheadDepth = 0;
     };
 }
\ No newline at end of file
@@ -18,21 +18,39 @@
 #pragma once
 
 #include <string>
+#include <functional>
 #include "ReturnType.h"
 
 namespace PLP {
+    enum PagedReaderType {
+        PAGED_READER_FSTREAM = 0,
+        PAGED_READER_MEMORY_MAPPED = 1,
+        PAGED_READER_IO_URING = 2
+    };
+
     class IndexReaderI;
+    class LiteralSearcher;
     class FileReaderI {
     public:
         virtual ~FileReaderI() {}
         virtual LineReaderResult nextLine(char*& lineStart, unsigned int& length) = 0;
+        // Skips ahead to the next line that contains literal, searching whole pages instead of splitting every line.
+        // Returns NOT_FOUND if there is no such line up to maxLineNumber
+        virtual LineReaderResult nextLineContaining(const LiteralSearcher& literal, unsigned long long maxLineNumber, char*& lineStart, unsigned int& length) = 0;
         virtual LineReaderResult getLine(unsigned long long lineNumber, char*& data, unsigned int& size) = 0;
         virtual LineReaderResult getLineFromResult(const IndexReaderI* rsReader, char*& data, unsigned int& size) = 0;
+        virtual LineReaderResult getLineAtOffset(unsigned long long lineNumber, unsigned long long fileOffset, char*& data, unsigned int& size) = 0;
+        virtual void prefetchLine(unsigned long long fileOffset) = 0;
+        // Called before the reader replaces the page that holds the lines it returned, which are not valid afterwards.
+        // Lets a caller keep pointers to several lines instead of copying them. nullptr to remove
+        virtual void setPageReleaseCallback(const std::function<void()>* callback) = 0;
         virtual unsigned long long getLineFileOffset() const = 0;
         virtual const wchar_t* getFilePath() const = 0;
         virtual unsigned long long getLineNumber() const = 0;
         virtual unsigned long long getNumberOfLines() const = 0;
         virtual void restart() = 0;
         virtual void release() = 0;
+        // Opens another reader of the same file that shares the line index. Returns nullptr on failure
+        virtual FileReaderI* clone() = 0;
     };
 }
@@ -0,0 +1,70 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+namespace PLP {
+    // Index file layout (.lcidx):
+    //   unsigned int version
+    //   unsigned int data file path length, data file path
+    //   unsigned long long number of results
+    // Version 1 follows with a fixed 16 byte record per result: line number, file offset.
+    // Version 2 follows with:
+    //   unsigned long long file offset of the skip table
+    //   unsigned int number of results per block
+    //   blocks of results: the first result of a block as two varints, then the zigzag encoded deltas of
+    //   the line number and file offset of each result to the previous one
+    //   skip table: the file offset of each block as an unsigned long long
+    static const unsigned int INDEX_VERSION_FIXED = 1;
+    static const unsigned int INDEX_VERSION_ENCODED = 2;
+    static const unsigned int INDEX_BLOCK_NUM_RESULTS = 1024;
+    static const unsigned int MAX_VARINT_BYTES = 10;
+    static const unsigned int MAX_ENCODED_RESULT_BYTES = MAX_VARINT_BYTES * 2;
+
+    // Writes value 7 bits at a time, low bits first. Returns the number of bytes written
+    inline unsigned int encodeVarint(unsigned long long value, char* out) {
+        unsigned int size = 0;
+        while (value >= 0x80) {
+            out[size++] = (char)(value | 0x80);
+            value >>= 7;
+        }
+        out[size++] = (char)value;
+        return size;
+    }
+
+    // Returns false if the varint does not end before end
+    inline bool decodeVarint(const char*& data, const char* end, unsigned long long& value) {
+        value = 0;
+        for (unsigned int shift = 0; data < end && shift < 64; shift += 7) {
+            const unsigned char byte = (unsigned char)*data++;
+            value |= (unsigned long long)(byte & 0x7F) << shift;
+            if (byte < 0x80) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Maps the signed difference to an unsigned value that stays small for small differences in either direction
+    inline unsigned long long encodeDelta(unsigned long long prev, unsigned long long curr) {
+        return curr >= prev ? (curr - prev) << 1 : ((prev - curr) << 1) - 1;
+    }
+
+    inline unsigned long long decodeDelta(unsigned long long prev, unsigned long long delta) {
+        return (delta & 1) ? prev - ((delta + 1) >> 1) : prev + (delta >> 1);
+    }
+}
@@ -0,0 +1,238 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IndexMerger.h"
+
+#include <cstring>
+#include <new>
+
+namespace PLP {
+    IndexMerger::IndexMerger(const std::vector<IndexReaderI*>& indexReaders, IndexSetOperation operation)
+        : _indexReaders(indexReaders), _operation(operation) {}
+
+    bool IndexMerger::initialize() {
+        if (_indexReaders.empty() || (_operation != INDEX_UNION && _operation != INDEX_INTERSECTION && _operation != INDEX_DIFFERENCE)) {
+            return false;
+        }
+
+        try {
+            for (IndexReaderI* indexReader : _indexReaders) {
+                if (!indexReader) {
+                    return false;
+                }
+                _cursors.emplace_back(indexReader);
+                if (!_cursors.back().initialize()) {
+                    return false;
+                }
+            }
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+        return true;
+    }
+
+    bool IndexMerger::run(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled) {
+        switch (_operation) {
+        case INDEX_UNION:
+            return runUnion(onResult, cancelled);
+        case INDEX_INTERSECTION:
+            return runIntersection(onResult, cancelled);
+        default:
+            return runDifference(onResult, cancelled);
+        }
+    }
+
+    bool IndexMerger::runUnion(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled) {
+        unsigned long long currNumOps = 0;
+        while (true) {
+            const IndexResult* first = nullptr;
+            for (Cursor& cursor : _cursors) {
+                if (cursor.isValid() && (!first || cursor.get().lineNum < first->lineNum)) {
+                    first = &cursor.get();
+                }
+            }
+            if (!first) {
+                break;
+            }
+
+            const IndexResult result = *first;
+            if (!onResult(result.lineNum, result.fileOffset)) {
+                return !failed();
+            }
+            for (Cursor& cursor : _cursors) {
+                if (cursor.isValid() && cursor.get().lineNum == result.lineNum) {
+                    cursor.next();
+                }
+            }
+
+            if (++currNumOps % NUM_OPS_TILL_CHECK_CANCELLED == 0 && cancelled) {
+                return false;
+            }
+        }
+        return !failed();
+    }
+
+    bool IndexMerger::runIntersection(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled) {
+        unsigned long long currNumOps = 0;
+        Cursor& first = _cursors.front();
+        while (first.isValid()) {
+            // every index skips to the furthest line of the others until they agree
+            unsigned long long target = first.get().lineNum;
+            bool agree = true;
+            for (Cursor& cursor : _cursors) {
+                cursor.seek(target);
+                if (!cursor.isValid()) {
+                    return !failed();
+                }
+                if (cursor.get().lineNum != target) {
+                    target = cursor.get().lineNum;
+                    agree = false;
+                }
+            }
+
+            if (!agree) {
+                first.seek(target);
+            } else {
+                if (!onResult(target, first.get().fileOffset)) {
+                    return !failed();
+                }
+                first.next();
+            }
+
+            if (++currNumOps % NUM_OPS_TILL_CHECK_CANCELLED == 0 && cancelled) {
+                return false;
+            }
+        }
+        return !failed();
+    }
+
+    bool IndexMerger::runDifference(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled) {
+        unsigned long long currNumOps = 0;
+        Cursor& first = _cursors.front();
+        for (; first.isValid(); first.next()) {
+            const IndexResult result = first.get();
+            bool excluded = false;
+            for (size_t i = 1; i < _cursors.size() && !excluded; i++) {
+                _cursors[i].seek(result.lineNum);
+                excluded = _cursors[i].isValid() && _cursors[i].get().lineNum == result.lineNum;
+            }
+
+            if (!excluded && !onResult(result.lineNum, result.fileOffset)) {
+                return !failed();
+            }
+
+            if (++currNumOps % NUM_OPS_TILL_CHECK_CANCELLED == 0 && cancelled) {
+                return false;
+            }
+        }
+        return !failed();
+    }
+
+    bool IndexMerger::failed() const {
+        for (const Cursor& cursor : _cursors) {
+            if (cursor.failed()) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool IndexMerger::Cursor::initialize() {
+        try {
+            _buffer.resize(BUFFER_NUM_RESULTS);
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+
+        _indexReader->restart();
+        fill();
+        return true;
+    }
+
+    bool IndexMerger::Cursor::isValid() const {
+        return _pos < _size;
+    }
+
+    const IndexResult& IndexMerger::Cursor::get() const {
+        return _buffer[_pos];
+    }
+
+    void IndexMerger::Cursor::next() {
+        if (++_pos >= _size) {
+            fill();
+        }
+    }
+
+    void IndexMerger::Cursor::seek(unsigned long long lineNum) {
+        if (!isValid() || _buffer[_pos].lineNum >= lineNum) {
+            return;
+        }
+
+        if (_buffer[_size - 1].lineNum < lineNum) {
+            // past the buffered results, the reader binary searches the index
+            if (_exhausted) {
+                _pos = _size;
+                return;
+            }
+            if (!_indexReader->seekToLine(lineNum)) { // no result at or after lineNum, or the index could not be read
+                _pos = _size;
+                _exhausted = true;
+                _failed = _indexReader->getResultNumber() + 1 < _indexReader->getNumResults();
+                return;
+            }
+            _pos = _size;
+            fill();
+            return;
+        }
+
+        // gallop to a range that holds lineNum, then binary search it
+        size_t step = 1;
+        size_t low = _pos;
+        while (low + step < _size && _buffer[low + step].lineNum < lineNum) {
+            low += step;
+            step *= 2;
+        }
+        size_t high = low + step < _size ? low + step : _size - 1;
+        while (low < high) {
+            const size_t mid = low + (high - low) / 2;
+            if (_buffer[mid].lineNum < lineNum) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+        _pos = low;
+    }
+
+    bool IndexMerger::Cursor::failed() const {
+        return _failed;
+    }
+
+    void IndexMerger::Cursor::fill() {
+        _pos = 0;
+        _size = 0;
+        if (_exhausted) {
+            return;
+        }
+
+        _size = (size_t)_indexReader->nextResults(_buffer.data(), _buffer.size());
+        if (_size == 0) {
+            _exhausted = true;
+            _failed = _indexReader->getResultNumber() + 1 < _indexReader->getNumResults();
+        }
+    }
+}
@@ -0,0 +1,80 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "IndexReaderI.h"
+
+#include <vector>
+#include <functional>
+#include <atomic>
+
+namespace PLP {
+    enum IndexSetOperation {
+        INDEX_UNION = 0,
+        INDEX_INTERSECTION = 1,
+        INDEX_DIFFERENCE = 2 // results of the first index that are in none of the others
+    };
+
+    // Combines indexes of the same file by merging their results, which are sorted by line number.
+    // Readers that are far behind the others skip ahead by galloping through their buffered results
+    // and then by seeking the index, so a small index is combined with a large one at the cost of the small one
+    class IndexMerger {
+    public:
+        IndexMerger(const std::vector<IndexReaderI*>& indexReaders, IndexSetOperation operation);
+        bool initialize();
+
+        // Calls onResult for each resulting line in order until it returns false. Returns false if a reader failed or on cancel
+        bool run(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled);
+
+    private:
+        class Cursor {
+        public:
+            Cursor(IndexReaderI* indexReader) : _indexReader(indexReader) {}
+            bool initialize();
+
+            bool isValid() const;
+            const IndexResult& get() const;
+            void next();
+            // Moves to the first result at or after lineNum
+            void seek(unsigned long long lineNum);
+            bool failed() const;
+
+        private:
+            static const unsigned int BUFFER_NUM_RESULTS = 256;
+            void fill();
+
+            IndexReaderI* _indexReader;
+            std::vector<IndexResult> _buffer;
+            size_t _pos = 0;
+            size_t _size = 0;
+            bool _exhausted = false;
+            bool _failed = false;
+        };
+
+        bool runUnion(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled);
+        bool runIntersection(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled);
+        bool runDifference(const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)>& onResult, const std::atomic<bool>& cancelled);
+        bool failed() const;
+
+        static const unsigned int NUM_OPS_TILL_CHECK_CANCELLED = 100000;
+
+        std::vector<IndexReaderI*> _indexReaders;
+        IndexSetOperation _operation;
+        std::vector<Cursor> _cursors;
+    };
+}
@@ -17,11 +17,15 @@
 
 #include "IndexReader.h"
 #include "MemMappedPagedReader.h"
-#include "FStreamPagedReader.h"
+#include "MemPagedReader.h"
+#include "MemFileStore.h"
 #include "Utils.h"
 #include "Logger.h"
+#include "IndexFormat.h"
 
 #include <fstream>
+#include <cstring>
+#include <algorithm>
 
 namespace PLP {
     IndexReader::IndexReader() {}
@@ -46,36 +50,70 @@ namespace PLP {
             return false;
         }
 
-        FStreamPagedReader* reader = new FStreamPagedReader();
-        _reader.reset(reader);
-        if (!reader->initialize(unixPath, preferredBufferSizeBytes)) {
-            return false;
+        std::shared_ptr<std::vector<char>> memFile = MemFileStore::get(unixPath);
+        if (memFile) {
+            MemPagedReader* reader = new MemPagedReader();
+            _reader.reset(reader);
+            if (!reader->initialize(unixPath, memFile)) {
+                return false;
+            }
+        } else {
+            MemMappedPagedReader* reader = new MemMappedPagedReader();
+            _reader.reset(reader);
+            if (!reader->initialize(unixPath, preferredBufferSizeBytes)) {
+                return false;
+            }
         }
 
-        _pageData = const_cast<char*>(_reader->read(0, _pageSize));
-        if (!_pageData || _pageSize == 0) {
+        unsigned long long pageSize = 0;
+        const char* pageData = _reader->read(0, pageSize);
+        if (!pageData || pageSize < sizeof(RESULT_SET_VERSION) + sizeof(unsigned int)) {
             return false;
         }
-        _currPageOffset = 0;
+        unsigned long long pageOffset = 0;
 
-        unsigned int version = 0;
-        std::memcpy(&version, _pageData + _currPageOffset, sizeof(RESULT_SET_VERSION));
-        if (version != RESULT_SET_VERSION) {
-            return false; //TODO can we handle legacy versions
+        std::memcpy(&_version, pageData + pageOffset, sizeof(RESULT_SET_VERSION));
+        if (_version != INDEX_VERSION_FIXED && _version != INDEX_VERSION_ENCODED) {
+            Logger::send(ERR, "Unsupported index file version " + std::to_string(_version));
+            return false;
         }
 
-        _currPageOffset += sizeof(RESULT_SET_VERSION);
+        pageOffset += sizeof(RESULT_SET_VERSION);
         unsigned int dataFilePathLength = 0;
-        std::memcpy(&dataFilePathLength, _pageData + _currPageOffset, sizeof(dataFilePathLength));
+        std::memcpy(&dataFilePathLength, pageData + pageOffset, sizeof(dataFilePathLength));
 
-        _currPageOffset += sizeof(dataFilePathLength);
-        _dataFilePath = std::string(_pageData + _currPageOffset, dataFilePathLength);
+        pageOffset += sizeof(dataFilePathLength);
+        const unsigned long long countsSize = _version == INDEX_VERSION_FIXED ?
+            sizeof(unsigned long long) : sizeof(unsigned long long) * 2 + sizeof(unsigned int);
+        if (pageSize - pageOffset < (unsigned long long)dataFilePathLength + countsSize) {
+            return false;
+        }
+        _dataFilePath = std::string(pageData + pageOffset, dataFilePathLength);
 
-        _currPageOffset += dataFilePathLength;
-        std::memcpy(&_numResults, _pageData + _currPageOffset, sizeof(unsigned long long));
+        pageOffset += dataFilePathLength;
+        std::memcpy(&_numResults, pageData + pageOffset, sizeof(unsigned long long));
+        pageOffset += sizeof(unsigned long long);
 
-        _currPageOffset += sizeof(unsigned long long);
-        _fileOffset = _currPageOffset;
+        const unsigned long long fileSize = _reader->getFileSize();
+        if (_version == INDEX_VERSION_FIXED) {
+            _headerSize = pageOffset;
+            if ((fileSize - _headerSize) / RESULT_SIZE_BYTES < _numResults) {
+                Logger::send(ERR, "Index file " + wstring_to_string(unixPath) + " is shorter than its number of results");
+                return false;
+            }
+        } else {
+            unsigned long long skipTableFileOffset = 0;
+            std::memcpy(&skipTableFileOffset, pageData + pageOffset, sizeof(skipTableFileOffset));
+            pageOffset += sizeof(skipTableFileOffset);
+            std::memcpy(&_blockNumResults, pageData + pageOffset, sizeof(_blockNumResults));
+            pageOffset += sizeof(_blockNumResults);
+            _headerSize = pageOffset;
+
+            if (!readSkipTable(skipTableFileOffset, fileSize)) {
+                Logger::send(ERR, "Index file " + wstring_to_string(unixPath) + " has an invalid skip table");
+                return false;
+            }
+        }
 
         _readingLock = std::move(readingLock);
         return true;
@@ -87,12 +125,51 @@ namespace PLP {
         _dataFilePath;
         _numResults = 0;
         _resultCount = 0;
-        _currPageOffset = 0;
         _currLineNum = 0;
         _currLineFileOffset = 0;
-        _pageData = nullptr;
-        _pageSize = 0;
-        _fileOffset = 0;
+        _headerSize = 0;
+        _version = 0;
+        _blockNumResults = 0;
+        _blockFileOffsets.clear();
+        _decodeCount = 0;
+        _decodeFileOffset = 0;
+    }
+
+    bool IndexReader::readSkipTable(unsigned long long skipTableFileOffset, unsigned long long fileSize) {
+        if (_blockNumResults == 0 || skipTableFileOffset < _headerSize || skipTableFileOffset > fileSize) {
+            return false;
+        }
+
+        const unsigned long long numBlocks = (_numResults + _blockNumResults - 1) / _blockNumResults;
+        if ((fileSize - skipTableFileOffset) / sizeof(unsigned long long) < numBlocks) {
+            return false;
+        }
+
+        try {
+            _blockFileOffsets.resize((size_t)numBlocks);
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+
+        unsigned long long numRead = 0;
+        while (numRead < numBlocks) {
+            unsigned long long size = 0;
+            const char* data = _reader->read(skipTableFileOffset + numRead * sizeof(unsigned long long), size);
+            const unsigned long long numInView = std::min(size / sizeof(unsigned long long), numBlocks - numRead);
+            if (!data || numInView == 0) {
+                return false;
+            }
+
+            std::memcpy(_blockFileOffsets.data() + numRead, data, (size_t)(numInView * sizeof(unsigned long long)));
+            numRead += numInView;
+        }
+
+        for (unsigned long long blockFileOffset : _blockFileOffsets) {
+            if (blockFileOffset < _headerSize || blockFileOffset >= skipTableFileOffset) {
+                return false;
+            }
+        }
+        return true;
     }
 
     bool IndexReader::getResult(unsigned long long number, unsigned long long& lineNumber) {
@@ -100,17 +177,7 @@ namespace PLP {
             return false;
         }
 
-        unsigned long long headerSize =
-            sizeof(RESULT_SET_VERSION) +
-            sizeof(unsigned int) + //length of data file path variable size
-            _dataFilePath.length() +
-            sizeof(_resultCount);
-
-        _pageData = nullptr;
-        _pageSize = 0;
         _resultCount = number;
-        _fileOffset = headerSize + (sizeof(unsigned long long) * 2) * number;
-
         return nextResult(lineNumber);
     }
 
@@ -123,29 +190,12 @@ namespace PLP {
     }
 
     bool IndexReader::nextResult(unsigned long long& lineNumber) {
-        if (_resultCount >= _numResults) {
+        IndexResult result;
+        if (nextResults(&result, 1) != 1) {
             return false;
         }
 
-        if (_pageData == nullptr || _pageSize == 0 || _pageSize - _currPageOffset < sizeof(unsigned long long) * 2) {
-            _pageData = const_cast<char*>(_reader->read(_fileOffset, _pageSize));
-            if (!_pageData || _pageSize == 0) {
-                return false;
-            }
-            _currPageOffset = 0;
-        }
-        char* data = _pageData + _currPageOffset;
-        std::memcpy(&_currLineNum, _pageData + _currPageOffset, sizeof(_currLineNum));
-        _currPageOffset += sizeof(_currLineNum);
-        _fileOffset += sizeof(_currLineNum);
-
-        std::memcpy(&_currLineFileOffset, _pageData + _currPageOffset, sizeof(_currLineFileOffset));
-        _currPageOffset += sizeof(_currLineFileOffset);
-        _fileOffset += sizeof(_currLineFileOffset);;
-
-        _resultCount++;
-
-        lineNumber = _currLineNum;
+        lineNumber = result.lineNum;
         return true;
     }
 
@@ -157,6 +207,178 @@ namespace PLP {
         return { true, lineNum };
     }
 
+    unsigned long long IndexReader::nextResults(IndexResult* results, unsigned long long maxNumResults) {
+        const unsigned long long numRead = _version == INDEX_VERSION_FIXED ?
+            readFixedResults(results, maxNumResults) : decodeResults(results, maxNumResults);
+
+        if (numRead > 0) {
+            _currLineNum = results[numRead - 1].lineNum;
+            _currLineFileOffset = results[numRead - 1].fileOffset;
+        }
+        return numRead;
+    }
+
+    unsigned long long IndexReader::readFixedResults(IndexResult* results, unsigned long long maxNumResults) {
+        static_assert(sizeof(IndexResult) == RESULT_SIZE_BYTES, "IndexResult must match the result record");
+
+        unsigned long long numRead = 0;
+        while (numRead < maxNumResults && _resultCount < _numResults) {
+            // the mapped view slides forward before it runs short, so only the end of the file cuts a record
+            unsigned long long size = 0;
+            const char* data = _reader->read(_headerSize + _resultCount * RESULT_SIZE_BYTES, size);
+            const unsigned long long numInView = std::min(
+                size / RESULT_SIZE_BYTES, 
+                std::min(maxNumResults - numRead, _numResults - _resultCount)
+            );
+            if (!data || numInView == 0) {
+                break;
+            }
+
+            std::memcpy(results + numRead, data, (size_t)(numInView * RESULT_SIZE_BYTES));
+            numRead += numInView;
+            _resultCount += numInView;
+        }
+        return numRead;
+    }
+
+    unsigned long long IndexReader::decodeResults(IndexResult* results, unsigned long long maxNumResults) {
+        if (_resultCount >= _numResults || maxNumResults == 0) {
+            return 0;
+        }
+
+        // decoding goes on from the last result read unless the next one is behind it or in another block,
+        // then it starts over from the beginning of the block through the skip table
+        const unsigned long long block = _resultCount / _blockNumResults;
+        if (_decodeFileOffset == 0 || _decodeCount > _resultCount || _decodeCount / _blockNumResults != block) {
+            _decodeCount = block * _blockNumResults;
+            _decodeFileOffset = _blockFileOffsets[(size_t)block];
+        }
+
+        unsigned long long numRead = 0;
+        while (numRead < maxNumResults && _decodeCount < _numResults) {
+            unsigned long long size = 0;
+            const char* data = _reader->read(_decodeFileOffset, size);
+            if (!data) {
+                _decodeFileOffset = 0;
+                break;
+            }
+
+            // the view is refreshed before a result can be cut by its end
+            const char* pos = data;
+            const char* end = data + size;
+            const bool endIsFileEnd = _decodeFileOffset + size >= _reader->getFileSize();
+            while (numRead < maxNumResults && _decodeCount < _numResults && (endIsFileEnd || end - pos >= (ptrdiff_t)MAX_ENCODED_RESULT_BYTES)) {
+                unsigned long long lineNumValue;
+                unsigned long long fileOffsetValue;
+                if (!decodeVarint(pos, end, lineNumValue) || !decodeVarint(pos, end, fileOffsetValue)) {
+                    Logger::send(ERR, "Index file " + wstring_to_string(_path) + " is corrupted");
+                    _decodeFileOffset = 0;
+                    return numRead;
+                }
+
+                if (_decodeCount % _blockNumResults == 0) {
+                    _decodeLineNum = lineNumValue;
+                    _decodeLineFileOffset = fileOffsetValue;
+                } else {
+                    _decodeLineNum = decodeDelta(_decodeLineNum, lineNumValue);
+                    _decodeLineFileOffset = decodeDelta(_decodeLineFileOffset, fileOffsetValue);
+                }
+
+                if (_decodeCount++ >= _resultCount) {
+                    results[numRead++] = { _decodeLineNum, _decodeLineFileOffset };
+                    _resultCount++;
+                }
+            }
+
+            if (pos == data) {
+                _decodeFileOffset = 0;
+                break;
+            }
+            _decodeFileOffset += (unsigned long long)(pos - data);
+        }
+        return numRead;
+    }
+
+    bool IndexReader::seekToLine(unsigned long long lineNumber) {
+        // line numbers increase from result to result, so the first result at lineNumber is binary searched
+        if (_version == INDEX_VERSION_FIXED) {
+            unsigned long long low = 0;
+            unsigned long long high = _numResults;
+            while (low < high) {
+                const unsigned long long mid = low + (high - low) / 2;
+                unsigned long long size = 0;
+                const char* data = _reader->read(_headerSize + mid * RESULT_SIZE_BYTES, size);
+                if (!data || size < RESULT_SIZE_BYTES) {
+                    return false;
+                }
+
+                unsigned long long midLineNum;
+                std::memcpy(&midLineNum, data, sizeof(midLineNum));
+                if (midLineNum < lineNumber) {
+                    low = mid + 1;
+                } else {
+                    high = mid;
+                }
+            }
+
+            _resultCount = low;
+            return low < _numResults;
+        }
+
+        // the block that can hold the result is found from the first line of each block, then searched through
+        unsigned long long low = 0;
+        unsigned long long high = _blockFileOffsets.size();
+        while (low < high) {
+            const unsigned long long mid = low + (high - low) / 2;
+            unsigned long long midLineNum;
+            if (!getBlockFirstLine(mid, midLineNum)) {
+                return false;
+            }
+
+            if (midLineNum <= lineNumber) {
+                low = mid + 1;
+            } else {
+                high = mid;
+            }
+        }
+
+        const unsigned long long block = low > 0 ? low - 1 : 0;
+        _resultCount = block * _blockNumResults;
+        while (_resultCount < _numResults) {
+            IndexResult results[64];
+            const unsigned long long numRead = decodeResults(results, 64);
+            if (numRead == 0) {
+                return false;
+            }
+
+            for (unsigned long long i = 0; i < numRead; i++) {
+                if (results[i].lineNum >= lineNumber) {
+                    _resultCount -= numRead - i;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    bool IndexReader::getBlockFirstLine(unsigned long long block, unsigned long long& lineNumber) {
+        unsigned long long size = 0;
+        const char* data = _reader->read(_blockFileOffsets[(size_t)block], size);
+        return data && decodeVarint(data, data + size, lineNumber);
+    }
+
+    std::vector<unsigned long long> IndexReader::nextResults(unsigned long long maxNumResults) {
+        std::vector<IndexResult> results((size_t)std::min(maxNumResults, _numResults - _resultCount));
+        results.resize((size_t)nextResults(results.data(), results.size()));
+
+        std::vector<unsigned long long> lineNums;
+        lineNums.reserve(results.size());
+        for (const IndexResult& result : results) {
+            lineNums.push_back(result.lineNum);
+        }
+        return lineNums;
+    }
+
     unsigned long long IndexReader::getNumResults() const {
         return _numResults;
     }
@@ -170,13 +392,11 @@ namespace PLP {
     }
 
     void IndexReader::restart() {
-        _currPageOffset = 0;
         _resultCount = 0;
-        _pageData = nullptr;
-        _pageSize = 0;
+        _decodeCount = 0;
+        _decodeFileOffset = 0;
         _currLineNum = 0;
         _currLineFileOffset = 0;
-        _fileOffset = 0;
     }
 
     unsigned long long IndexReader::getLineNumber() const {
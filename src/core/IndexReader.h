@@ -23,6 +23,7 @@
 #include <string>
 #include <memory>
 #include <tuple>
+#include <vector>
 
 namespace PLP {
     class PagedReader;
@@ -39,10 +40,13 @@ namespace PLP {
         unsigned long long getLineFileOffset() const override;
         bool getResult(unsigned long long number, unsigned long long& lineNumber) override;
         bool nextResult(unsigned long long& lineNumber) override;
+        unsigned long long nextResults(IndexResult* results, unsigned long long maxNumResults) override;
+        bool seekToLine(unsigned long long lineNumber) override;
 
         //Lua interface
         std::tuple<bool, unsigned long long> getResult(unsigned long long number);
         std::tuple<bool, unsigned long long> nextResult();
+        std::vector<unsigned long long> nextResults(unsigned long long maxNumResults);
 
         //Shared interface
         unsigned long long getLineNumber() const override;
@@ -54,18 +58,32 @@ namespace PLP {
         void release() override;
 
     private:
+        // version 1 results are fixed size records following the header, so the mapped file is indexed directly
+        static const unsigned long long RESULT_SIZE_BYTES = sizeof(unsigned long long) * 2;
+
+        bool readSkipTable(unsigned long long skipTableFileOffset, unsigned long long fileSize);
+        unsigned long long readFixedResults(IndexResult* results, unsigned long long maxNumResults);
+        unsigned long long decodeResults(IndexResult* results, unsigned long long maxNumResults);
+        bool getBlockFirstLine(unsigned long long block, unsigned long long& lineNumber);
+
         std::unique_ptr<PagedReader> _reader = nullptr;
         std::wstring _path;
         std::string _dataFilePath;
         unsigned long long _numResults = 0;
         unsigned long long _resultCount = 0;
-        unsigned long long _currPageOffset = 0;
         unsigned long long _currLineNum = 0;
         unsigned long long _currLineFileOffset = 0;
-        unsigned long long _fileOffset = 0;
+        unsigned long long _headerSize = 0;
+        unsigned int _version = 0;
+
+        // version 2: results are decoded from the start of a block, found through the skip table
+        unsigned int _blockNumResults = 0;
+        std::vector<unsigned long long> _blockFileOffsets;
+        unsigned long long _decodeCount = 0; // number of the next result to decode
+        unsigned long long _decodeFileOffset = 0; // 0 if decoding has to restart from a block
+        unsigned long long _decodeLineNum = 0;
+        unsigned long long _decodeLineFileOffset = 0;
 
-        char* _pageData = nullptr;
-        unsigned long long _pageSize = 0;
         FileScopedLock _readingLock;
     };
 }
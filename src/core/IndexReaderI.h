@@ -20,12 +20,21 @@
 #include <string>
 
 namespace PLP {
+    struct IndexResult {
+        unsigned long long lineNum;
+        unsigned long long fileOffset;
+    };
+
     class IndexReaderI {
     public:
         virtual ~IndexReaderI() {}
         virtual unsigned long long getLineFileOffset() const = 0;
         virtual bool getResult(unsigned long long number, unsigned long long& lineNumber) = 0;
         virtual bool nextResult(unsigned long long& lineNumber) = 0;
+        // Reads up to maxNumResults results following the current one, returns the number read
+        virtual unsigned long long nextResults(IndexResult* results, unsigned long long maxNumResults) = 0;
+        // Positions the reader so that the next result is the first one at or after lineNumber. Returns false if there is none
+        virtual bool seekToLine(unsigned long long lineNumber) = 0;
         virtual unsigned long long getLineNumber() const = 0;
         virtual unsigned long long getNumResults() const = 0;
         virtual unsigned long long getResultNumber() const = 0;
@@ -17,11 +17,13 @@
 
 #include "IndexWriter.h"
 #include "FStreamPagedWriter.h"
+#include "MemPagedWriter.h"
 #include "Utils.h"
 #include "FileReader.h"
 #include "TaskRunner.h"
 #include "Logger.h"
 #include "GenFileTracker.h"
+#include "IndexFormat.h"
 
 namespace PLP {
     IndexWriter::IndexWriter() {}
@@ -36,6 +38,29 @@ namespace PLP {
         unsigned long long preferredBufferSizeBytes,
         bool overwriteIfExists,
         TaskRunner& asyncTaskRunner
+    ) {
+        return initializeGeneral(path, dataFilePath, preferredBufferSizeBytes, false, 0, overwriteIfExists, asyncTaskRunner);
+    }
+
+    bool IndexWriter::initializeInMemory(
+        const std::wstring& path,
+        const std::wstring& dataFilePath,
+        unsigned long long preferredBufferSizeBytes,
+        unsigned long long memoryBudgetBytes,
+        bool overwriteIfExists,
+        TaskRunner& asyncTaskRunner
+    ) {
+        return initializeGeneral(path, dataFilePath, preferredBufferSizeBytes, true, memoryBudgetBytes, overwriteIfExists, asyncTaskRunner);
+    }
+
+    bool IndexWriter::initializeGeneral(
+        const std::wstring& path,
+        const std::wstring& dataFilePath,
+        unsigned long long preferredBufferSizeBytes,
+        bool inMemory,
+        unsigned long long memoryBudgetBytes,
+        bool overwriteIfExists,
+        TaskRunner& asyncTaskRunner
     ) {
         release();
 
@@ -55,13 +80,22 @@ namespace PLP {
 
         _dataFilePath = wstring_to_string(dataFilePath);
 
-        FStreamPagedWriter* writer = new FStreamPagedWriter();
-        _writer.reset(writer);
-        if (!writer->initialize(indexPath, preferredBufferSizeBytes, overwriteIfExists, asyncTaskRunner)) {
-            return false;
-        }
+        if (inMemory) {
+            // the index is written to disk only if it outgrows the memory budget
+            MemPagedWriter* writer = new MemPagedWriter();
+            _writer.reset(writer);
+            if (!writer->initialize(indexPath, memoryBudgetBytes, preferredBufferSizeBytes, overwriteIfExists, asyncTaskRunner)) {
+                return false;
+            }
+        } else {
+            FStreamPagedWriter* writer = new FStreamPagedWriter();
+            _writer.reset(writer);
+            if (!writer->initialize(indexPath, preferredBufferSizeBytes, overwriteIfExists, asyncTaskRunner)) {
+                return false;
+            }
 
-        LC::GenFileTracker::addFile(indexPath);
+            LC::GenFileTracker::addFile(indexPath);
+        }
 
         if (!_writer->write(reinterpret_cast<const char*>(&RESULT_SET_VERSION), sizeof(RESULT_SET_VERSION))) {
             return false;
@@ -76,22 +110,40 @@ namespace PLP {
         if (!_writer->write(reinterpret_cast<const char*>(&_resultCount), sizeof(_resultCount))) {
             return false;
         }
+        if (!_writer->write(reinterpret_cast<const char*>(&_skipTableFileOffset), sizeof(_skipTableFileOffset))) {
+            return false;
+        }
+        if (!_writer->write(reinterpret_cast<const char*>(&INDEX_BLOCK_NUM_RESULTS), sizeof(INDEX_BLOCK_NUM_RESULTS))) {
+            return false;
+        }
         if (!_writer->flush()) {
             return false;
         }
 
+        _fileOffset =
+            sizeof(RESULT_SET_VERSION) +
+            sizeof(dataFilePathLength) +
+            dataFilePathLength +
+            sizeof(_resultCount) +
+            sizeof(_skipTableFileOffset) +
+            sizeof(INDEX_BLOCK_NUM_RESULTS);
+
         _writingLock = std::move(writingLock);
         return true;
     }
 
     void IndexWriter::release() {
         if (_writer) {
-            flush();
+            finish();
         }
         _writer = nullptr;
         _dataFilePath = "";
         _prevLineNum = 0;
+        _prevFileOffset = 0;
         _resultCount = 0;
+        _fileOffset = 0;
+        _skipTableFileOffset = 0;
+        _blockFileOffsets.clear();
     }
 
     bool IndexWriter::appendCurrLine(const FileReaderI* fReader) {
@@ -112,19 +164,43 @@ namespace PLP {
             return false;
         }
 
-        if (!_writer->write(reinterpret_cast<const char*>(&lineNumber), sizeof(unsigned long long))) {
-            return false;
+        // blocks start with absolute values so that a reader can decode from any entry of the skip table
+        char encoded[MAX_ENCODED_RESULT_BYTES];
+        unsigned int size = 0;
+        if (_resultCount % INDEX_BLOCK_NUM_RESULTS == 0) {
+            try {
+                _blockFileOffsets.push_back(_fileOffset);
+            } catch (std::bad_alloc&) {
+                Logger::send(ERR, "Failed to allocate memory for index skip table");
+                return false;
+            }
+            size += encodeVarint(lineNumber, encoded);
+            size += encodeVarint(fileOffset, encoded + size);
+        } else {
+            size += encodeVarint(encodeDelta(_prevLineNum, lineNumber), encoded);
+            size += encodeVarint(encodeDelta(_prevFileOffset, fileOffset), encoded + size);
         }
-        if (!_writer->write(reinterpret_cast<const char*>(&fileOffset), sizeof(unsigned long long))) {
+
+        if (!_writer->write(encoded, size)) {
             return false;
         }
 
+        _fileOffset += size;
         _resultCount++;
         _prevLineNum = lineNumber;
+        _prevFileOffset = fileOffset;
         return true;
     }
 
-    bool IndexWriter::flush() {
+    bool IndexWriter::finish() {
+        _skipTableFileOffset = _fileOffset;
+        if (!_blockFileOffsets.empty()) {
+            const unsigned long long skipTableSize = _blockFileOffsets.size() * sizeof(unsigned long long);
+            if (!_writer->write(reinterpret_cast<const char*>(_blockFileOffsets.data()), skipTableSize)) {
+                return false;
+            }
+        }
+
         if (!_writer->flush()) {
             return false;
         }
@@ -147,6 +223,9 @@ namespace PLP {
         if (!_writer->write(reinterpret_cast<const char*>(&_resultCount), sizeof(_resultCount))) {
             return false;
         }
+        if (!_writer->write(reinterpret_cast<const char*>(&_skipTableFileOffset), sizeof(_skipTableFileOffset))) {
+            return false;
+        }
         if (!_writer->setPositionEnd()) {
             return false;
         }
@@ -23,6 +23,7 @@
 #include <string>
 #include <memory>
 #include <sstream>
+#include <vector>
 
 namespace PLP {
     class PagedWriter;
@@ -42,6 +43,16 @@ namespace PLP {
             TaskRunner& asyncTaskRunner
         );
 
+        // Keeps the index in MemFileStore, where IndexReader finds it by path
+        bool initializeInMemory(
+            const std::wstring& path,
+            const std::wstring& dataFilePath,
+            unsigned long long preferredBufferSizeBytes,
+            unsigned long long memoryBudgetBytes, //0 for no limit
+            bool overwriteIfExists,
+            TaskRunner& asyncTaskRunner
+        );
+
         //C++ interface
         bool appendCurrLine(const FileReaderI* fReader) override;
         bool appendCurrLine(unsigned long long lineNumber, unsigned long long fileOffset) override;
@@ -54,14 +65,29 @@ namespace PLP {
         void release() override;
 
     private:
-        bool flush();
+        bool initializeGeneral(
+            const std::wstring& path,
+            const std::wstring& dataFilePath,
+            unsigned long long preferredBufferSizeBytes,
+            bool inMemory,
+            unsigned long long memoryBudgetBytes,
+            bool overwriteIfExists,
+            TaskRunner& asyncTaskRunner
+        );
+
+        // writes the skip table and the final header
+        bool finish();
         bool updateResultCount();
 
         std::unique_ptr<PagedWriter> _writer = nullptr;
         std::string _dataFilePath;
         
         unsigned long long _prevLineNum = 0;
+        unsigned long long _prevFileOffset = 0;
         unsigned long long _resultCount = 0;
+        unsigned long long _fileOffset = 0; // end of the written results
+        unsigned long long _skipTableFileOffset = 0;
+        std::vector<unsigned long long> _blockFileOffsets;
 
         FileScopedLock _writingLock;
     };
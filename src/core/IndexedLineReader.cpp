@@ -17,23 +17,27 @@
 
 #include "IndexedLineReader.h"
 #include "Utils.h"
+#include "ByteSearch.h"
 #include "Core.h"
 #include "Logger.h"
 #include "GenFileTracker.h"
+#include "ThreadPool.h"
 
 #include "cereal/types/vector.hpp"
 #include "cereal/types/string.hpp"
 #include "cereal/archives/binary.hpp"
 
 #include <fstream>
+#include <thread>
 
 namespace PLP {
-    IndexedLineReader::IndexedLineReader() {}
+    IndexedLineReader::IndexedLineReader() : _fileIndex(new std::vector<unsigned long long>()) {}
     IndexedLineReader::~IndexedLineReader() {}
 
     bool IndexedLineReader::initialize(
         PagedReader& pagedReader, 
         unsigned int maxLineSize, 
+        ThreadPool* workerPool,
         const std::atomic<bool>& cancelled, 
         const std::function<void(int percent)>* progressUpdate
     ) {
@@ -44,7 +48,7 @@ namespace PLP {
         std::wstring indexPath = getIndexFilePath(pagedReader.getFilePath());
         (*progressUpdate)(0);
         if (!loadIndex(indexPath)) {
-            if (!generateIndex(pagedReader.getFilePath(), indexPath, cancelled, pagedReader.getFileSize(), progressUpdate)) {
+            if (!generateIndex(pagedReader.getFilePath(), indexPath, workerPool, cancelled, pagedReader.getFileSize(), progressUpdate)) {
                 return false;
             }
         } else {
@@ -54,6 +58,16 @@ namespace PLP {
         return true;
     }
 
+    bool IndexedLineReader::initialize(PagedReader& pagedReader, unsigned int maxLineSize, const IndexedLineReader& other) {
+        if (!LineReader::initialize(pagedReader, maxLineSize)) {
+            return false;
+        }
+
+        _indexHeader = other._indexHeader;
+        _fileIndex = other._fileIndex;
+        return true;
+    }
+
     std::wstring IndexedLineReader::getIndexFilePath(const std::wstring& dataFilePath) {
         std::wstring directory = getFileDirectory(dataFilePath);
         std::wstring fileNameNoExt = getFileNameNoExt(dataFilePath);
@@ -76,7 +90,7 @@ namespace PLP {
                 return false;
             }
 
-            iarchive(_indexHeader, _fileIndex);
+            iarchive(_indexHeader, *_fileIndex);
         } catch (const cereal::Exception& e) {
             Logger::send(ERR, "Failed to load file random access index: " + std::string(e.what()));
             return false;
@@ -88,15 +102,69 @@ namespace PLP {
     bool IndexedLineReader::generateIndex(
         const std::wstring& dataFilePath, 
         const std::wstring& indexPath, 
+        ThreadPool* workerPool,
         const std::atomic<bool>& cancelled,
         const unsigned long long fileSize,
         const std::function<void(int percent)>* progressUpdate
     ) {
-        char* lineStart;
-        unsigned int length;
+        // The file is split into chunks that workers load and count line endings in. Chunks are then stitched
+        // into the index in file order: the line number at the start of each chunk is only known at that point,
+        // and the block counts let the checkpoints be located without rescanning the whole chunk
+        const unsigned long long numChunks = (fileSize + INDEX_CHUNK_SIZE_BYTES - 1) / INDEX_CHUNK_SIZE_BYTES;
+        unsigned long long numSlots = workerPool ? workerPool->getNumThreads() + 2 : 1;
+        if (numSlots > numChunks) {
+            numSlots = numChunks;
+        }
+
+        std::vector<std::unique_ptr<IndexChunk>> chunks;
+        try {
+            _fileIndex->reserve(fileSize / ESTIMATED_NUM_CHARS_PER_LINE);
+            for (unsigned long long i = 0; i < numSlots; i++) {
+                chunks.emplace_back(new IndexChunk());
+                chunks.back()->buffer.resize(INDEX_CHUNK_SIZE_BYTES);
+                chunks.back()->blocks.resize(INDEX_CHUNK_SIZE_BYTES / INDEX_BLOCK_SIZE_BYTES);
+            }
+        } catch (std::bad_alloc&) {
+            Logger::send(ERR, "Failed to allocate enough space for index buffer");
+            return false;
+        }
+
+        auto scheduleChunk = [&](unsigned long long chunkNum) {
+            IndexChunk& chunk = *chunks[chunkNum % numSlots];
+            chunk.fileOffset = chunkNum * INDEX_CHUNK_SIZE_BYTES;
+            chunk.size = fileSize - chunk.fileOffset > INDEX_CHUNK_SIZE_BYTES ? INDEX_CHUNK_SIZE_BYTES : fileSize - chunk.fileOffset;
+            if (workerPool) {
+                workerPool->runAsync([&dataFilePath, &chunk]() {
+                    scanChunk(dataFilePath, chunk);
+                }, chunk.status);
+            } else {
+                scanChunk(dataFilePath, chunk);
+            }
+        };
+
         unsigned long long lineStartFileOffset = 0;
         unsigned long long numLines = 0;
 
+        // records the lines ending in [begin, end), same as the stitching below but one line ending at a time
+        auto addLineEndings = [&](const char* begin, const char* end, unsigned long long beginFileOffset) {
+            const char* pos = begin;
+            while ((pos = findByte(pos, end, '\n')) != end) {
+                const unsigned long long nextLineStartFileOffset = beginFileOffset + (pos - begin) + 1;
+                if (nextLineStartFileOffset - lineStartFileOffset > _maxLineSize) {
+                    return false;
+                }
+
+                if (numLines % LINE_INDEX_FREQUENCY == 0) {
+                    _fileIndex->push_back(lineStartFileOffset);
+                }
+
+                lineStartFileOffset = nextLineStartFileOffset;
+                numLines++;
+                pos++;
+            }
+            return true;
+        };
+
         const long double dBytesPerPercent = (fileSize) / 100.0;
         const unsigned long long numBytesPerProgressUpdate = dBytesPerPercent > 1.0 ? (unsigned long long)dBytesPerPercent : 1;
         const int percentPerProgressUpdate = dBytesPerPercent > 1.0 ? 1 : (int)(1.0 / dBytesPerPercent);
@@ -104,37 +172,99 @@ namespace PLP {
         unsigned long long numBytesTillProgressUpdate = numBytesPerProgressUpdate;
         int progressPercent = 0;
 
-        LineReaderResult result;
+        for (unsigned long long i = 0; i < numSlots; i++) {
+            scheduleChunk(i);
+        }
+
+        bool succeeded = true;
         try {
-            _fileIndex.reserve(fileSize / ESTIMATED_NUM_CHARS_PER_LINE);
-            while ((result = nextLine(lineStart, length)) == LineReaderResult::SUCCESS) {
-                if (getLineNumber() % 10000000 == 0 && cancelled) {
-                    return false;
+            for (unsigned long long chunkNum = 0; chunkNum < numChunks && succeeded; chunkNum++) {
+                IndexChunk& chunk = *chunks[chunkNum % numSlots];
+                if (workerPool) {
+                    workerPool->wait(chunk.status, cancelled);
                 }
 
-                if (getLineNumber() % LINE_INDEX_FREQUENCY == 0) {
-                    _fileIndex.push_back(lineStartFileOffset);
+                if (cancelled) {
+                    succeeded = false;
+                    break;
                 }
 
-                lineStartFileOffset = getCurrentFileOffset();
-                numLines++;
+                if (chunk.readErrorOccurred) {
+                    Logger::send(ERR, "Failed to read file " + wstring_to_string(dataFilePath));
+                    succeeded = false;
+                    break;
+                }
+
+                const unsigned long long numBlocks = (chunk.size + INDEX_BLOCK_SIZE_BYTES - 1) / INDEX_BLOCK_SIZE_BYTES;
+                for (unsigned long long blockNum = 0; blockNum < numBlocks; blockNum++) {
+                    const BlockLineEndings& lineEndings = chunk.blocks[blockNum];
+                    const unsigned long long blockOffset = blockNum * INDEX_BLOCK_SIZE_BYTES;
+                    const unsigned long long blockSize = chunk.size - blockOffset > INDEX_BLOCK_SIZE_BYTES ? INDEX_BLOCK_SIZE_BYTES : chunk.size - blockOffset;
+                    const unsigned long long blockFileOffset = chunk.fileOffset + blockOffset;
+
+                    if (lineEndings.count > 0) {
+                        const unsigned long long nextCheckpoint = (numLines + LINE_INDEX_FREQUENCY - 1) / LINE_INDEX_FREQUENCY * LINE_INDEX_FREQUENCY;
+                        if (nextCheckpoint < numLines + lineEndings.count || _maxLineSize < INDEX_BLOCK_SIZE_BYTES) {
+                            const char* blockData = chunk.buffer.data() + blockOffset;
+                            if (!addLineEndings(blockData, blockData + blockSize, blockFileOffset)) {
+                                succeeded = false;
+                                break;
+                            }
+                        } else {
+                            if (blockFileOffset + lineEndings.first + 1 - lineStartFileOffset > _maxLineSize) {
+                                succeeded = false;
+                                break;
+                            }
+                            numLines += lineEndings.count;
+                            lineStartFileOffset = blockFileOffset + lineEndings.last + 1;
+                        }
+                    }
+
+                    if (blockFileOffset + blockSize - lineStartFileOffset > _maxLineSize) {
+                        succeeded = false;
+                        break;
+                    }
+                }
+
+                if (!succeeded) {
+                    Logger::send(ERR, "Line size exceeds maximum");
+                    break;
+                }
 
-                if (lineStartFileOffset > numBytesTillProgressUpdate) {
+                if (chunkNum + numSlots < numChunks) {
+                    scheduleChunk(chunkNum + numSlots);
+                }
+
+                const unsigned long long fileOffset = chunk.fileOffset + chunk.size;
+                while (fileOffset > numBytesTillProgressUpdate && progressPercent < 100) {
                     progressPercent += percentPerProgressUpdate;
                     numBytesTillProgressUpdate += numBytesPerProgressUpdate;
                     (*progressUpdate)(progressPercent);
                 }
             }
+
+            if (succeeded && lineStartFileOffset < fileSize) { // last line is not terminated
+                if (numLines % LINE_INDEX_FREQUENCY == 0) {
+                    _fileIndex->push_back(lineStartFileOffset);
+                }
+                numLines++;
+            }
         } catch (std::bad_alloc&) {
             Logger::send(ERR, "Failed to allocate enough space for index buffer");
-            return false;
+            succeeded = false;
         }
 
-        if (result == LineReaderResult::ERROR) {
-            return false;
+        // workers still reference the chunks
+        if (workerPool) {
+            const std::atomic<bool> notCancelled(false);
+            for (auto& chunk : chunks) {
+                workerPool->wait(chunk->status, notCancelled);
+            }
         }
 
-        restart();
+        if (!succeeded) {
+            return false;
+        }
 
         std::ofstream fs;
         fs.open(indexPath, std::fstream::out | std::fstream::binary);
@@ -151,7 +281,7 @@ namespace PLP {
 
         try {
             cereal::BinaryOutputArchive oarchive(fs);
-            oarchive(INDEX_VERSION, _indexHeader, _fileIndex);
+            oarchive(INDEX_VERSION, _indexHeader, *_fileIndex);
         } catch (const cereal::Exception& e) {
             Logger::send(ERR, "Failed to write index file " + wstring_to_string(indexPath) + ": " + std::string(e.what()));
             return false;
@@ -160,6 +290,38 @@ namespace PLP {
         return true;
     }
 
+    void IndexedLineReader::scanChunk(const std::wstring& dataFilePath, IndexChunk& chunk) {
+        chunk.readErrorOccurred = false;
+
+        std::ifstream fs;
+        fs.open(dataFilePath, std::fstream::in | std::fstream::binary);
+        if (!fs.good()) {
+            chunk.readErrorOccurred = true;
+            return;
+        }
+
+        fs.seekg(chunk.fileOffset);
+        fs.read(chunk.buffer.data(), chunk.size);
+        if ((unsigned long long)fs.gcount() != chunk.size) {
+            chunk.readErrorOccurred = true;
+            return;
+        }
+
+        const unsigned long long numBlocks = (chunk.size + INDEX_BLOCK_SIZE_BYTES - 1) / INDEX_BLOCK_SIZE_BYTES;
+        for (unsigned long long blockNum = 0; blockNum < numBlocks; blockNum++) {
+            const unsigned long long blockOffset = blockNum * INDEX_BLOCK_SIZE_BYTES;
+            const unsigned long long blockSize = chunk.size - blockOffset > INDEX_BLOCK_SIZE_BYTES ? INDEX_BLOCK_SIZE_BYTES : chunk.size - blockOffset;
+            const char* blockData = chunk.buffer.data() + blockOffset;
+
+            BlockLineEndings& lineEndings = chunk.blocks[blockNum];
+            lineEndings.count = (unsigned int)countByte(blockData, blockData + blockSize, '\n');
+            if (lineEndings.count > 0) {
+                lineEndings.first = (unsigned int)(findByte(blockData, blockData + blockSize, '\n') - blockData);
+                lineEndings.last = (unsigned int)(findLastLineEnding(blockData, blockSize, blockData + blockSize - 1) - blockData);
+            }
+        }
+    }
+
     LineReaderResult IndexedLineReader::getLine(unsigned long long lineNumber, char*& data, unsigned int& size) {
         if (lineNumber < 0 || lineNumber > _indexHeader.numLines - 1) {
             return LineReaderResult::NOT_FOUND;
@@ -178,11 +340,11 @@ namespace PLP {
             if (prevIndexedLineNum == 0) {
                 prevIndexedLineFileOffset = 0;
             } else {
-                if (prevIndexedLineNumIndex >= _fileIndex.size()) {
+                if (prevIndexedLineNumIndex >= _fileIndex->size()) {
                     Logger::send(ERR, "Failed to find nearest known file location");
                     return LineReaderResult::ERROR;
                 }
-                prevIndexedLineFileOffset = _fileIndex[prevIndexedLineNumIndex];
+                prevIndexedLineFileOffset = (*_fileIndex)[prevIndexedLineNumIndex];
             }
 
             LineReaderResult result = getLineUnverified(prevIndexedLineNum, prevIndexedLineFileOffset, lineData, length);
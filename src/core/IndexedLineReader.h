@@ -19,12 +19,15 @@
 #include "LineReader.h"
 #include "PagedReader.h"
 #include "ReturnType.h"
+#include "TaskRunner.h"
 
 #include <vector>
+#include <memory>
 #include <atomic>
 #include <functional>
 
 namespace PLP {
+    class ThreadPool;
     class IndexedLineReader : public LineReader {
     public:
         IndexedLineReader();
@@ -33,9 +36,12 @@ namespace PLP {
         bool initialize(
             PagedReader& pagedReader, 
             unsigned int maxLineSize, 
+            ThreadPool* workerPool,
             const std::atomic<bool>& cancelled,
             const std::function<void(int percent)>* progressUpdate
         );
+        // shares the loaded index of another reader of the same file
+        bool initialize(PagedReader& pagedReader, unsigned int maxLineSize, const IndexedLineReader& other);
         LineReaderResult getLine(unsigned long long lineNumber, char*& data, unsigned int& size);
         unsigned long long getNumberOfLines();
     private:
@@ -44,11 +50,31 @@ namespace PLP {
         bool generateIndex(
             const std::wstring& dataFilePath, 
             const std::wstring& indexPath,
+            ThreadPool* workerPool,
             const std::atomic<bool>& cancelled,
             const unsigned long long fileSize,
             const std::function<void(int percent)>* progressUpdate
         );
 
+        // line endings found in one block of a chunk, offsets are relative to the start of the block
+        struct BlockLineEndings {
+            unsigned int count = 0;
+            unsigned int first = 0;
+            unsigned int last = 0;
+        };
+
+        // byte range of the file scanned by a worker. The data stays loaded until the chunk is stitched into the index
+        struct IndexChunk {
+            std::vector<char> buffer;
+            std::vector<BlockLineEndings> blocks;
+            unsigned long long fileOffset = 0;
+            unsigned long long size = 0;
+            bool readErrorOccurred = false;
+            TaskStatus status;
+        };
+
+        static void scanChunk(const std::wstring& dataFilePath, IndexChunk& chunk);
+
         struct IndexHeader {
             std::string filePath;
             unsigned long long numLines = 0;
@@ -63,8 +89,10 @@ namespace PLP {
         static const unsigned int INDEX_VERSION = 1; // increment if format changes
         static const unsigned int LINE_INDEX_FREQUENCY = 1000;
         static const unsigned long long ESTIMATED_NUM_CHARS_PER_LINE = 100;
+        static const unsigned long long INDEX_CHUNK_SIZE_BYTES = 4 * 1024 * 1024; //4 MB
+        static const unsigned int INDEX_BLOCK_SIZE_BYTES = 4096;
 
-        std::vector<unsigned long long> _fileIndex;
+        std::shared_ptr<std::vector<unsigned long long>> _fileIndex;
         IndexHeader _indexHeader;
     };
 }
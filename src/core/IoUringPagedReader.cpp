@@ -0,0 +1,410 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "IoUringPagedReader.h"
+#include "Utils.h"
+
+#ifdef __linux__
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/uio.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+
+#ifndef __NR_io_uring_setup
+#define __NR_io_uring_setup 425
+#endif
+#ifndef __NR_io_uring_enter
+#define __NR_io_uring_enter 426
+#endif
+#endif
+
+namespace PLP {
+    IoUringPagedReader::IoUringPagedReader() {}
+    IoUringPagedReader::~IoUringPagedReader() {
+        // the kernel writes into the page buffers until the reads complete
+        while (_numInFlight > 0 && reapCompletions(true)) {}
+        releaseRing();
+
+#ifdef __linux__
+        if (_fileDescriptor >= 0) {
+            close(_fileDescriptor);
+        }
+#endif
+    }
+
+#ifdef __linux__
+    bool IoUringPagedReader::initialize(
+        const std::wstring& path, 
+        unsigned long long preferredBuffSize, 
+        unsigned int readAheadDepth, 
+        unsigned int queueDepth
+    ) {
+        _filePath = path;
+        _readAheadDepth = readAheadDepth;
+
+        if (queueDepth == 0) {
+            return false;
+        }
+
+        if (preferredBuffSize < OPTIMAL_BLOCK_SIZE_BYTES) {
+            _pageSizeBytes = OPTIMAL_BLOCK_SIZE_BYTES;
+        } else {
+            _pageSizeBytes = preferredBuffSize / OPTIMAL_BLOCK_SIZE_BYTES * OPTIMAL_BLOCK_SIZE_BYTES;
+        }
+
+        _fileDescriptor = open(wstring_to_string(path).c_str(), O_RDONLY);
+        if (_fileDescriptor < 0) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(_fileDescriptor, &fileStat) != 0) {
+            return false;
+        }
+        _fileSize = fileStat.st_size;
+
+        if (!setupRing(queueDepth)) {
+            return false;
+        }
+
+        // one page is handed out to the caller while the rest are in flight
+        try {
+            _pages.resize(queueDepth + 1);
+            _iovecs.resize(sizeof(struct iovec) * _pages.size());
+            for (size_t i = 0; i < _pages.size(); i++) {
+                _pages[i].buffer.resize(_pageSizeBytes);
+                _pages[i].iovec = _iovecs.data() + sizeof(struct iovec) * i;
+            }
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+
+        return true;
+    }
+
+    bool IoUringPagedReader::setupRing(unsigned int queueDepth) {
+        struct io_uring_params params;
+        memset(&params, 0, sizeof(params));
+
+        _ringFd = (int)syscall(__NR_io_uring_setup, queueDepth, &params);
+        if (_ringFd < 0) { // ENOSYS on kernels without io_uring, EPERM when it is disabled
+            return false;
+        }
+
+        _sqRingSize = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+        _cqRingSize = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+        const bool singleMap = (params.features & IORING_FEAT_SINGLE_MMAP) != 0;
+        if (singleMap) {
+            _sqRingSize = _cqRingSize = _sqRingSize > _cqRingSize ? _sqRingSize : _cqRingSize;
+        }
+
+        void* sqRing = mmap(nullptr, _sqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQ_RING);
+        if (sqRing == MAP_FAILED) {
+            return false;
+        }
+        _sqRing = sqRing;
+
+        if (singleMap) {
+            _cqRing = _sqRing;
+        } else {
+            void* cqRing = mmap(nullptr, _cqRingSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_CQ_RING);
+            if (cqRing == MAP_FAILED) {
+                return false;
+            }
+            _cqRing = cqRing;
+        }
+
+        _sqesSize = params.sq_entries * sizeof(struct io_uring_sqe);
+        void* sqes = mmap(nullptr, _sqesSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, _ringFd, IORING_OFF_SQES);
+        if (sqes == MAP_FAILED) {
+            return false;
+        }
+        _sqes = sqes;
+
+        char* sq = static_cast<char*>(_sqRing);
+        _sqHead = reinterpret_cast<unsigned int*>(sq + params.sq_off.head);
+        _sqTail = reinterpret_cast<unsigned int*>(sq + params.sq_off.tail);
+        _sqMask = reinterpret_cast<unsigned int*>(sq + params.sq_off.ring_mask);
+        _sqArray = reinterpret_cast<unsigned int*>(sq + params.sq_off.array);
+
+        char* cq = static_cast<char*>(_cqRing);
+        _cqHead = reinterpret_cast<unsigned int*>(cq + params.cq_off.head);
+        _cqTail = reinterpret_cast<unsigned int*>(cq + params.cq_off.tail);
+        _cqMask = reinterpret_cast<unsigned int*>(cq + params.cq_off.ring_mask);
+        _cqes = cq + params.cq_off.cqes;
+
+        return true;
+    }
+
+    void IoUringPagedReader::releaseRing() {
+        if (_sqes) {
+            munmap(_sqes, _sqesSize);
+            _sqes = nullptr;
+        }
+        if (_cqRing && _cqRing != _sqRing) {
+            munmap(_cqRing, _cqRingSize);
+        }
+        _cqRing = nullptr;
+        if (_sqRing) {
+            munmap(_sqRing, _sqRingSize);
+            _sqRing = nullptr;
+        }
+        if (_ringFd >= 0) {
+            close(_ringFd);
+            _ringFd = -1;
+        }
+    }
+
+    bool IoUringPagedReader::submitRead(unsigned int pageIndex, unsigned long long fileOffset, unsigned long long size) {
+        Page& page = _pages[pageIndex];
+        page.fileOffset = fileOffset;
+        page.size = size;
+        page.state = PAGE_LOADING;
+        page.consumed = false;
+        page.readErrorOccurred = false;
+
+        struct iovec* iov = static_cast<struct iovec*>(page.iovec);
+        iov->iov_base = page.buffer.data();
+        iov->iov_len = size;
+
+        // only this thread produces submissions, so the tail can be read without synchronization
+        const unsigned int tail = *_sqTail;
+        const unsigned int index = tail & *_sqMask;
+        struct io_uring_sqe* sqe = static_cast<struct io_uring_sqe*>(_sqes) + index;
+        memset(sqe, 0, sizeof(*sqe));
+        sqe->opcode = IORING_OP_READV;
+        sqe->fd = _fileDescriptor;
+        sqe->off = fileOffset;
+        sqe->addr = reinterpret_cast<unsigned long long>(iov);
+        sqe->len = 1;
+        sqe->user_data = pageIndex;
+
+        _sqArray[index] = index;
+        __atomic_store_n(_sqTail, tail + 1, __ATOMIC_RELEASE);
+
+        int submitted;
+        do {
+            submitted = (int)syscall(__NR_io_uring_enter, _ringFd, 1, 0, 0, nullptr, 0);
+        } while (submitted < 0 && errno == EINTR);
+
+        if (submitted != 1) {
+            page.state = PAGE_FREE;
+            return false;
+        }
+
+        _numInFlight++;
+        return true;
+    }
+
+    bool IoUringPagedReader::reapCompletions(bool wait) {
+        if (wait) {
+            int res;
+            do {
+                res = (int)syscall(__NR_io_uring_enter, _ringFd, 0, 1, IORING_ENTER_GETEVENTS, nullptr, 0);
+            } while (res < 0 && errno == EINTR);
+
+            if (res < 0) {
+                return false;
+            }
+        }
+
+        unsigned int head = *_cqHead;
+        const unsigned int tail = __atomic_load_n(_cqTail, __ATOMIC_ACQUIRE);
+        while (head != tail) {
+            const struct io_uring_cqe* cqe = static_cast<const struct io_uring_cqe*>(_cqes) + (head & *_cqMask);
+            Page& page = _pages[(size_t)cqe->user_data];
+            if (cqe->res <= 0) {
+                page.readErrorOccurred = true;
+            } else if ((unsigned long long)cqe->res < page.size) {
+                page.size = cqe->res; // short read, the rest is picked up by the next read
+            }
+            page.state = PAGE_READY;
+            _numInFlight--;
+            head++;
+        }
+        __atomic_store_n(_cqHead, head, __ATOMIC_RELEASE);
+
+        return true;
+    }
+#else
+    bool IoUringPagedReader::initialize(
+        const std::wstring& path, 
+        unsigned long long preferredBuffSize, 
+        unsigned int readAheadDepth, 
+        unsigned int queueDepth
+    ) {
+        _filePath = path;
+        return false;
+    }
+
+    bool IoUringPagedReader::setupRing(unsigned int queueDepth) {
+        return false;
+    }
+
+    void IoUringPagedReader::releaseRing() {}
+
+    bool IoUringPagedReader::submitRead(unsigned int pageIndex, unsigned long long fileOffset, unsigned long long size) {
+        return false;
+    }
+
+    bool IoUringPagedReader::reapCompletions(bool wait) {
+        return false;
+    }
+#endif
+
+    const char* IoUringPagedReader::read(unsigned long long fileOffset, unsigned long long& size) {
+        size = 0;
+        if (fileOffset >= _fileSize) {
+            return nullptr;
+        }
+
+        if (_numInFlight > 0 && !reapCompletions(false)) {
+            return nullptr;
+        }
+
+        const bool sequential = (_currPage < 0 && fileOffset == 0)
+            || (_currPage >= 0 && fileOffset == _pages[_currPage].fileOffset + _pages[_currPage].size);
+
+        int pageIndex = findPage(fileOffset, true);
+        if (pageIndex < 0) {
+            pageIndex = findFreePage(true);
+            while (pageIndex < 0) { // every page is in flight, wait for one of them to complete
+                if (!reapCompletions(true)) {
+                    return nullptr;
+                }
+                pageIndex = findFreePage(true);
+            }
+
+            const unsigned long long bytesTillEnd = _fileSize - fileOffset;
+            const unsigned long long bytesToRead = bytesTillEnd > _pageSizeBytes ? _pageSizeBytes : bytesTillEnd;
+            if (!submitRead(pageIndex, fileOffset, bytesToRead)) {
+                return nullptr;
+            }
+        }
+
+        Page& page = _pages[pageIndex];
+        while (page.state == PAGE_LOADING) {
+            if (!reapCompletions(true)) {
+                return nullptr;
+            }
+        }
+
+        if (page.readErrorOccurred) {
+            page.state = PAGE_FREE;
+            return nullptr;
+        }
+
+        if (fileOffset >= page.fileOffset + page.size) { // the page came back short of the requested offset
+            return read(fileOffset, size);
+        }
+
+        page.lastUsed = ++_useCounter;
+        page.consumed = true;
+        _currPage = pageIndex;
+
+        if (sequential) {
+            scheduleReadAhead(pageIndex);
+        }
+
+        const unsigned long long deltaOffset = fileOffset - page.fileOffset;
+        size = page.size - deltaOffset;
+        return page.buffer.data() + deltaOffset;
+    }
+
+    void IoUringPagedReader::prefetch(unsigned long long fileOffset) {
+        if (fileOffset >= _fileSize || _ringFd < 0 || findPage(fileOffset, true) >= 0) {
+            return;
+        }
+
+        // a hint only recycles pages that were already read, earlier hints that were not consumed yet are kept
+        int pageIndex = findFreePage(false);
+        if (pageIndex < 0) {
+            return;
+        }
+
+        const unsigned long long bytesTillEnd = _fileSize - fileOffset;
+        const unsigned long long bytesToRead = bytesTillEnd > RANDOM_READ_SIZE_BYTES ? RANDOM_READ_SIZE_BYTES : bytesTillEnd;
+        if (submitRead(pageIndex, fileOffset, bytesToRead)) {
+            // keep the hint from being evicted before the pages that were read before it
+            _pages[pageIndex].lastUsed = ++_useCounter;
+        }
+    }
+
+    int IoUringPagedReader::findPage(unsigned long long fileOffset, bool includeLoading) {
+        for (size_t i = 0; i < _pages.size(); i++) {
+            const Page& page = _pages[i];
+            if ((page.state == PAGE_READY || (includeLoading && page.state == PAGE_LOADING))
+                && !page.readErrorOccurred
+                && fileOffset >= page.fileOffset && fileOffset < page.fileOffset + page.size) {
+                return (int)i;
+            }
+        }
+        return -1;
+    }
+
+    int IoUringPagedReader::findFreePage(bool evictUnconsumed) {
+        int leastRecentlyUsed = -1;
+        for (size_t i = 0; i < _pages.size(); i++) {
+            const Page& page = _pages[i];
+            if (page.state == PAGE_FREE) {
+                return (int)i;
+            }
+            // the current page is still referenced by the caller
+            if (page.state == PAGE_READY && (int)i != _currPage && (evictUnconsumed || page.consumed)
+                && (leastRecentlyUsed < 0 || page.lastUsed < _pages[leastRecentlyUsed].lastUsed)) {
+                leastRecentlyUsed = (int)i;
+            }
+        }
+        return leastRecentlyUsed;
+    }
+
+    void IoUringPagedReader::scheduleReadAhead(unsigned int currPageIndex) {
+        unsigned long long nextFileOffset = _pages[currPageIndex].fileOffset + _pages[currPageIndex].size;
+        for (unsigned int i = 0; i < _readAheadDepth && nextFileOffset < _fileSize; i++) {
+            int pageIndex = findPage(nextFileOffset, true);
+            if (pageIndex < 0) {
+                pageIndex = findFreePage(true);
+                if (pageIndex < 0) {
+                    return;
+                }
+
+                const unsigned long long bytesTillEnd = _fileSize - nextFileOffset;
+                const unsigned long long bytesToRead = bytesTillEnd > _pageSizeBytes ? _pageSizeBytes : bytesTillEnd;
+                if (!submitRead(pageIndex, nextFileOffset, bytesToRead)) {
+                    return;
+                }
+            }
+
+            // keep read-ahead pages from being evicted before they are consumed
+            _pages[pageIndex].lastUsed = ++_useCounter;
+            nextFileOffset = _pages[pageIndex].fileOffset + _pages[pageIndex].size;
+        }
+    }
+
+    unsigned long long IoUringPagedReader::getFileSize() {
+        return _fileSize;
+    }
+
+    const std::wstring& IoUringPagedReader::getFilePath() {
+        return _filePath;
+    }
+}
\ No newline at end of file
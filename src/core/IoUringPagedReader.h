@@ -0,0 +1,105 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PagedReader.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace PLP {
+    // Reads pages through Linux io_uring keeping several reads in flight. Sequential reads are followed by
+    // read-ahead of the next pages, and offsets passed to prefetch() are loaded ahead of time so that scattered
+    // reads (lines pointed to by an index) are served at a high queue depth.
+    // initialize() fails when io_uring is not supported by the platform or the kernel
+    class IoUringPagedReader : public PagedReader {
+    public:
+        IoUringPagedReader();
+        ~IoUringPagedReader();
+
+        bool initialize(
+            const std::wstring& path, 
+            unsigned long long preferredBuffSize, 
+            unsigned int readAheadDepth, 
+            unsigned int queueDepth = DEFAULT_QUEUE_DEPTH
+        );
+        const char* read(unsigned long long fileOffset, unsigned long long& size) override;
+        void prefetch(unsigned long long fileOffset) override;
+        unsigned long long getFileSize() override;
+        const std::wstring& getFilePath() override;
+
+        static const unsigned int DEFAULT_QUEUE_DEPTH = 32;
+    private:
+        static const unsigned long long RANDOM_READ_SIZE_BYTES = 16384; //16 KB
+
+        enum PageState {
+            PAGE_FREE,
+            PAGE_LOADING,
+            PAGE_READY
+        };
+
+        struct Page {
+            std::vector<char> buffer;
+            unsigned long long fileOffset = 0;
+            unsigned long long size = 0;
+            unsigned long long lastUsed = 0;
+            PageState state = PAGE_FREE;
+            bool consumed = false;
+            bool readErrorOccurred = false;
+            void* iovec = nullptr;
+        };
+
+        bool setupRing(unsigned int queueDepth);
+        void releaseRing();
+        bool submitRead(unsigned int pageIndex, unsigned long long fileOffset, unsigned long long size);
+        bool reapCompletions(bool wait);
+        int findPage(unsigned long long fileOffset, bool includeLoading);
+        int findFreePage(bool evictUnconsumed);
+        void scheduleReadAhead(unsigned int currPageIndex);
+
+        std::wstring _filePath;
+        int _fileDescriptor = -1;
+        unsigned long long _fileSize = 0;
+        unsigned long long _pageSizeBytes = 0;
+        unsigned int _readAheadDepth = 0;
+
+        std::vector<Page> _pages;
+        std::vector<char> _iovecs;
+        int _currPage = -1;
+        unsigned long long _useCounter = 0;
+        unsigned int _numInFlight = 0;
+
+        // io_uring submission and completion queues shared with the kernel
+        int _ringFd = -1;
+        void* _sqRing = nullptr;
+        void* _cqRing = nullptr;
+        void* _sqes = nullptr;
+        unsigned long long _sqRingSize = 0;
+        unsigned long long _cqRingSize = 0;
+        unsigned long long _sqesSize = 0;
+        unsigned int* _sqHead = nullptr;
+        unsigned int* _sqTail = nullptr;
+        unsigned int* _sqMask = nullptr;
+        unsigned int* _sqArray = nullptr;
+        unsigned int* _cqHead = nullptr;
+        unsigned int* _cqTail = nullptr;
+        unsigned int* _cqMask = nullptr;
+        void* _cqes = nullptr;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,130 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LineBatch.h"
+#include "ComparatorPlan.h"
+
+namespace PLP {
+    LineBatch::LineBatch(unsigned int maxNumLines) : _maxNumLines(maxNumLines > 0 ? maxNumLines : 1) {}
+
+    LineBatch::~LineBatch() {
+        if (_reader) {
+            _reader->setPageReleaseCallback(nullptr);
+        }
+    }
+
+    void LineBatch::attach(FileReaderI* reader, const std::function<void()>& onPageRelease) {
+        _reader = reader;
+        _onPageRelease = onPageRelease;
+
+        std::function<void()> callback = [this]() {
+            _pageReleased = true;
+            if (!isEmpty()) {
+                _onPageRelease();
+            }
+        };
+        _reader->setPageReleaseCallback(&callback);
+    }
+
+    void LineBatch::add(unsigned long long lineNum, unsigned long long fileOffset, const char* data, unsigned int size) {
+        if (!_reader || _pageReleased) {
+            _copiedLines.push_back({ (unsigned int)_spans.size(), _copies.size() });
+            _copies.insert(_copies.end(), data, data + size);
+            data = nullptr; // set once the copies stop moving, see fillCopiedSpans
+            _pageReleased = false;
+        }
+
+        _spans.push_back({ data, size });
+        _lineNums.push_back(lineNum);
+        _fileOffsets.push_back(fileOffset);
+    }
+
+    bool LineBatch::isFull() const {
+        return _spans.size() >= _maxNumLines;
+    }
+
+    bool LineBatch::isEmpty() const {
+        return _spans.empty();
+    }
+
+    bool LineBatch::match(
+        ComparatorPlan& plan,
+        const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& onMatch
+    ) {
+        const unsigned int count = (unsigned int)_spans.size();
+        if (count == 0) {
+            return true;
+        }
+
+        fillCopiedSpans();
+        _selection.assign(count, 1);
+        plan.matchBatch(_spans.data(), count, _selection.data());
+
+        bool proceed = true;
+        for (unsigned int i = 0; i < count; i++) {
+            if (_selection[i] && !onMatch(_lineNums[i], _fileOffsets[i], _spans[i].data, _spans[i].size)) {
+                proceed = false;
+                break;
+            }
+        }
+
+        clear();
+        return proceed;
+    }
+
+    void LineBatch::matchEach(
+        std::vector<ComparatorPlan>& plans,
+        std::vector<unsigned char>& active,
+        const std::function<bool(size_t index, unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& onMatch
+    ) {
+        const unsigned int count = (unsigned int)_spans.size();
+        if (count == 0) {
+            return;
+        }
+
+        fillCopiedSpans();
+        for (size_t index = 0; index < plans.size(); index++) {
+            if (!active[index]) {
+                continue;
+            }
+
+            _selection.assign(count, 1);
+            plans[index].matchBatch(_spans.data(), count, _selection.data());
+            for (unsigned int i = 0; i < count; i++) {
+                if (_selection[i] && !onMatch(index, _lineNums[i], _fileOffsets[i], _spans[i].data, _spans[i].size)) {
+                    active[index] = 0;
+                    break;
+                }
+            }
+        }
+        clear();
+    }
+
+    void LineBatch::fillCopiedSpans() {
+        for (auto& copiedLine : _copiedLines) {
+            _spans[copiedLine.first].data = _copies.data() + copiedLine.second;
+        }
+    }
+
+    void LineBatch::clear() {
+        _spans.clear();
+        _lineNums.clear();
+        _fileOffsets.clear();
+        _copies.clear();
+        _copiedLines.clear();
+    }
+}
\ No newline at end of file
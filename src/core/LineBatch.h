@@ -0,0 +1,79 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FileReaderI.h"
+#include "TextComparator.h"
+
+#include <vector>
+#include <functional>
+
+namespace PLP {
+    class ComparatorPlan;
+
+    // Lines of a scan that are matched together, see TextComparator::matchBatch. Once attached to the reader, lines are
+    // kept as pointers into its page and the batch is flushed before the page is replaced. Only a line read while the page
+    // changed (it may have crossed the page boundary) is copied. Without a reader every line is copied
+    class LineBatch {
+    public:
+        static const unsigned int MAX_NUM_LINES = 4096;
+
+        explicit LineBatch(unsigned int maxNumLines = MAX_NUM_LINES);
+        ~LineBatch();
+
+        // onPageRelease has to empty the batch, usually by calling match
+        void attach(FileReaderI* reader, const std::function<void()>& onPageRelease);
+        void add(unsigned long long lineNum, unsigned long long fileOffset, const char* data, unsigned int size);
+        bool isFull() const;
+        bool isEmpty() const;
+
+        // Matches the lines, calls onMatch for the matching ones in line order and clears the batch.
+        // Returns false if onMatch did
+        bool match(
+            ComparatorPlan& plan,
+            const std::function<bool(unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& onMatch
+        );
+
+        // Matches the lines against each of the plans that is still active, onMatch gets the index of the plan.
+        // A plan is deactivated once onMatch returns false for it. Clears the batch
+        void matchEach(
+            std::vector<ComparatorPlan>& plans,
+            std::vector<unsigned char>& active,
+            const std::function<bool(size_t index, unsigned long long lineNum, unsigned long long fileOffset, const char* line, unsigned int length)>& onMatch
+        );
+
+    private:
+        LineBatch(const LineBatch&) = delete;
+        LineBatch& operator=(const LineBatch&) = delete;
+
+        void fillCopiedSpans();
+        void clear();
+
+        unsigned int _maxNumLines;
+        FileReaderI* _reader = nullptr;
+        std::function<void()> _onPageRelease;
+        bool _pageReleased = false;
+
+        std::vector<LineSpan> _spans;
+        std::vector<unsigned long long> _lineNums;
+        std::vector<unsigned long long> _fileOffsets;
+        std::vector<unsigned char> _selection;
+        std::vector<char> _copies;
+        std::vector<std::pair<unsigned int, size_t>> _copiedLines; // line in the batch, offset in _copies
+    };
+}
@@ -19,6 +19,8 @@
 #include "PagedReader.h"
 #include "Utils.h"
 #include "Logger.h"
+#include "ByteSearch.h"
+#include "LiteralSearcher.h"
 
 namespace PLP {
     LineReader::~LineReader() {
@@ -58,7 +60,7 @@ namespace PLP {
             //load a new page if required
             if (!_pageData || _pageSize == 0 || _pageOffset >= _pageSize || loadNextPage) {
                 _pageOffset = 0;
-                _pageData = const_cast<char*>(_pager->read(_fileOffset, _pageSize));
+                _pageData = const_cast<char*>(readPage());
                 if (!_pageData || _pageSize == 0) {
                     return LineReaderResult::NOT_FOUND;
                 }
@@ -71,6 +73,7 @@ namespace PLP {
             // find line ending
             LineReaderResult result = findNextLineEnding(_pageData, _pageSize, _pageOffset, _maxLineSize, lineEnd);
             if (result == LineReaderResult::ERROR) {
+                Logger::send(ERR, "Line size exceeds maximum");
                 return LineReaderResult::ERROR;
             }
 
@@ -117,6 +120,61 @@ namespace PLP {
         return LineReaderResult::SUCCESS;
     }
 
+    LineReaderResult LineReader::nextLineContaining(
+        const LiteralSearcher& literal,
+        unsigned long long maxLineNumber,
+        char*& data,
+        unsigned int& size
+    ) {
+        data = nullptr;
+        size = 0;
+
+        // The page is searched in windows that end on a line ending, so that the lines skipped are always complete.
+        // Reaching a hit or the end of a window only costs counting the line endings in between
+        while (true) {
+            if (!_pageData || _pageSize == 0 || _pageOffset >= _pageSize) {
+                _pageOffset = 0;
+                _pageData = const_cast<char*>(readPage());
+                if (!_pageData || _pageSize == 0) {
+                    return LineReaderResult::NOT_FOUND;
+                }
+            }
+
+            const char* windowStart = _pageData + _pageOffset;
+            const char* windowEnd = _pageData + std::min(_pageSize, _pageOffset + LITERAL_SEARCH_WINDOW_BYTES);
+            const char* hit = literal.find(windowStart, (unsigned int)(windowEnd - windowStart));
+
+            const char* skipEnd;
+            if (hit) {
+                const char* prevLineEnd = findLastByte(windowStart, hit, '\n');
+                skipEnd = prevLineEnd == hit ? windowStart : prevLineEnd + 1;
+            } else {
+                const char* lastLineEnd = findLastByte(windowStart, windowEnd, '\n');
+                skipEnd = lastLineEnd == windowEnd ? windowStart : lastLineEnd + 1;
+            }
+
+            const unsigned long long numSkipped = countByte(windowStart, skipEnd, '\n');
+            if (_lineCount + numSkipped > maxLineNumber) {
+                return LineReaderResult::NOT_FOUND;
+            }
+            _lineCount += numSkipped;
+            _pageOffset += skipEnd - windowStart;
+            _fileOffset += skipEnd - windowStart;
+
+            if (hit) {
+                return nextLine(data, size);
+            }
+
+            // the window is the start of a line that continues on the next page. Read it whole
+            if (skipEnd == windowStart) {
+                LineReaderResult result = nextLine(data, size);
+                if (result != LineReaderResult::SUCCESS || literal.find(data, size)) {
+                    return result;
+                }
+            }
+        }
+    }
+
     LineReaderResult LineReader::getLineUnverified(
         unsigned long long lineNum,
         unsigned long long fileOffset,
@@ -127,7 +185,7 @@ namespace PLP {
             return LineReaderResult::ERROR;
         }
 
-        _pageData = nullptr;
+        releasePage();
         _pageSize = 0;
 
         _lineCount = lineNum;
@@ -152,11 +210,27 @@ namespace PLP {
     }
 
     void LineReader::restart() {
-        _pageData = nullptr;
+        releasePage();
         _pageSize = 0;
         _pageOffset = 0;
         _fileOffset = 0;
         _lineCount = 0;
         _currentLineLength = 0;
     }
+
+    void LineReader::setPageReleaseCallback(const std::function<void()>* callback) {
+        _onPageRelease = callback ? *callback : nullptr;
+    }
+
+    const char* LineReader::readPage() {
+        releasePage();
+        return _pager->read(_fileOffset, _pageSize);
+    }
+
+    void LineReader::releasePage() {
+        if (_pageData && _onPageRelease) {
+            _onPageRelease();
+        }
+        _pageData = nullptr;
+    }
 }
\ No newline at end of file
@@ -21,15 +21,20 @@
 
 #include <vector>
 #include <memory>
+#include <functional>
 
 namespace PLP {
     class PagedReader;
+    class LiteralSearcher;
     class LineReader {
     public:
         virtual ~LineReader();
 
         bool initialize(PagedReader& pager, unsigned int maxLineSize);
         LineReaderResult nextLine(char*& data, unsigned int& size);
+        // Skips ahead to the next line that contains literal. Lines in between are counted but not split.
+        // Returns NOT_FOUND without moving past maxLineNumber if there is no such line up to it
+        LineReaderResult nextLineContaining(const LiteralSearcher& literal, unsigned long long maxLineNumber, char*& data, unsigned int& size);
         LineReaderResult getLineUnverified( //only use if you know what you are doing. Incorrect lineNum/fileOffset can cause undefined behavior
             unsigned long long lineNum, 
             unsigned long long fileOffset, 
@@ -40,8 +45,14 @@ namespace PLP {
         unsigned long long getCurrentFileOffset();
         unsigned long long getCurrentLineFileOffset();
         void restart();
+        // Called before the page that holds the lines returned so far is replaced, after which they are no longer valid.
+        // nullptr to remove
+        void setPageReleaseCallback(const std::function<void()>* callback);
 
     protected:
+        const char* readPage();
+        void releasePage();
+
         PagedReader* _pager = nullptr;
         char* _pageData = nullptr;
         unsigned long long _pageSize = 0;
@@ -52,5 +63,8 @@ namespace PLP {
 
         std::unique_ptr<LineBuffer> _pageBoundaryLineBuff;
         unsigned int _maxLineSize = 0;
+        std::function<void()> _onPageRelease;
+
+        static const unsigned long long LITERAL_SEARCH_WINDOW_BYTES = 1024 * 1024; // 1 MB, has to be larger than the maximum line size
     };
 }
\ No newline at end of file
@@ -0,0 +1,100 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "LiteralSearcher.h"
+#include "ByteSearch.h"
+#include "CaseFolding.h"
+
+#include <cstring>
+
+namespace PLP {
+    bool LiteralSearcher::initialize(const std::string& needle, bool ignoreCase) {
+        _needle = needle;
+        _ignoreCase = ignoreCase;
+        if (_ignoreCase) {
+            for (char& c : _needle) {
+                c = foldCaseAscii(c);
+            }
+        }
+        _useSimd = getSimdLevel() != SIMD_NONE;
+
+        const unsigned int needleSize = (unsigned int)_needle.size();
+        try {
+            _skipTable.assign(256, needleSize);
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+
+        for (unsigned int i = 0; i + 1 < needleSize; i++) {
+            _skipTable[(unsigned char)_needle[i]] = needleSize - 1 - i;
+            if (_ignoreCase && _needle[i] >= 'a' && _needle[i] <= 'z') {
+                _skipTable[(unsigned char)(_needle[i] - ('a' - 'A'))] = needleSize - 1 - i;
+            }
+        }
+        return true;
+    }
+
+    const char* LiteralSearcher::find(const char* data, unsigned int size) const {
+        const unsigned int needleSize = (unsigned int)_needle.size();
+        if (needleSize == 0) {
+            return data;
+        }
+        if (size < needleSize) {
+            return nullptr;
+        }
+
+        const char* end = data + size;
+        const char* pos;
+        if (_ignoreCase) {
+            if (!_useSimd) {
+                return findHorspool(data, size);
+            }
+            pos = findSubstringIgnoreCase(data, end, _needle.data(), needleSize);
+        } else if (needleSize == 1) {
+            pos = findByte(data, end, _needle[0]);
+        } else if (_useSimd) {
+            pos = findSubstring(data, end, _needle.data(), needleSize);
+        } else {
+            return findHorspool(data, size);
+        }
+        return pos == end ? nullptr : pos;
+    }
+
+    unsigned int LiteralSearcher::getNeedleSize() const {
+        return (unsigned int)_needle.size();
+    }
+
+    const char* LiteralSearcher::findHorspool(const char* data, unsigned int size) const {
+        const unsigned int needleSize = (unsigned int)_needle.size();
+        const char* needle = _needle.data();
+        const char lastByte = needle[needleSize - 1];
+
+        unsigned int offset = 0;
+        while (offset <= size - needleSize) {
+            const unsigned char windowLastByte = (unsigned char)data[offset + needleSize - 1];
+            if (_ignoreCase) {
+                if (foldCaseAscii((char)windowLastByte) == lastByte && equalsIgnoreCaseAscii(data + offset, needle, needleSize - 1)) {
+                    return data + offset;
+                }
+            } else if ((char)windowLastByte == lastByte && memcmp(data + offset, needle, needleSize - 1) == 0) {
+                return data + offset;
+            }
+            offset += _skipTable[windowLastByte];
+        }
+        return nullptr;
+    }
+}
\ No newline at end of file
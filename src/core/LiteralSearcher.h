@@ -0,0 +1,42 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+namespace PLP {
+    // Finds a fixed string in a span of bytes without copying it. Uses the SIMD first/last byte filter when the CPU
+    // supports it, otherwise Boyer-Moore-Horspool with a skip table built in initialize().
+    // With ignoreCase the needle is lowercased once up front and only ASCII letters of the data are folded while searching
+    class LiteralSearcher {
+    public:
+        bool initialize(const std::string& needle, bool ignoreCase = false);
+        // Returns the first occurrence of the needle in data or nullptr. An empty needle matches at the start of data
+        const char* find(const char* data, unsigned int size) const;
+        unsigned int getNeedleSize() const;
+
+    private:
+        const char* findHorspool(const char* data, unsigned int size) const;
+
+        std::string _needle;
+        std::vector<unsigned int> _skipTable;
+        bool _useSimd = false;
+        bool _ignoreCase = false;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,116 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MatchCount.h"
+
+#include <algorithm>
+#include <new>
+
+namespace PLP {
+    bool MatchCount::initialize(unsigned long long startLine, unsigned long long endLine, unsigned int numBuckets) {
+        if (startLine > endLine) {
+            return false;
+        }
+
+        _startLine = startLine;
+        const unsigned long long numLines = endLine - startLine + 1;
+        _bucketNumLines = numBuckets > 0 ? (numLines + numBuckets - 1) / numBuckets : 0;
+        try {
+            _buckets.assign(numBuckets, 0);
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+        _touchedBegin = 0;
+        _touchedEnd = 0;
+        clear();
+        return true;
+    }
+
+    void MatchCount::clear() {
+        _numMatches = 0;
+        _firstLine = 0;
+        _lastLine = 0;
+        std::fill(_buckets.begin() + _touchedBegin, _buckets.begin() + _touchedEnd, 0);
+        _touchedBegin = 0;
+        _touchedEnd = 0;
+    }
+
+    void MatchCount::add(unsigned long long lineNum) {
+        if (_numMatches == 0) {
+            _firstLine = lineNum;
+        }
+        _lastLine = lineNum;
+        _numMatches++;
+
+        if (_bucketNumLines > 0 && lineNum >= _startLine) {
+            const unsigned long long bucket = (lineNum - _startLine) / _bucketNumLines;
+            if (bucket < _buckets.size()) {
+                _buckets[(size_t)bucket]++;
+                touch((size_t)bucket, (size_t)bucket + 1);
+            }
+        }
+    }
+
+    void MatchCount::merge(const MatchCount& other) {
+        if (other._numMatches == 0) {
+            return;
+        }
+        if (_numMatches == 0) {
+            _firstLine = other._firstLine;
+        }
+        _lastLine = other._lastLine;
+        _numMatches += other._numMatches;
+
+        const size_t end = std::min(other._touchedEnd, _buckets.size());
+        if (other._touchedBegin < end) {
+            for (size_t i = other._touchedBegin; i < end; i++) {
+                _buckets[i] += other._buckets[i];
+            }
+            touch(other._touchedBegin, end);
+        }
+    }
+
+    void MatchCount::touch(size_t begin, size_t end) {
+        if (_touchedBegin == _touchedEnd) {
+            _touchedBegin = begin;
+            _touchedEnd = end;
+        } else {
+            _touchedBegin = std::min(_touchedBegin, begin);
+            _touchedEnd = std::max(_touchedEnd, end);
+        }
+    }
+
+    unsigned long long MatchCount::getNumMatches() const {
+        return _numMatches;
+    }
+
+    unsigned long long MatchCount::getFirstLine() const {
+        return _firstLine;
+    }
+
+    unsigned long long MatchCount::getLastLine() const {
+        return _lastLine;
+    }
+
+    unsigned long long MatchCount::getBucketNumLines() const {
+        return _bucketNumLines;
+    }
+
+    const std::vector<unsigned long long>& MatchCount::getBuckets() const {
+        return _buckets;
+    }
+}
@@ -0,0 +1,56 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace PLP {
+    // Result of a count-only search: the number of matching lines, the first and last of them and a histogram
+    // of the matches over equal ranges of lines. Partial counts of consecutive ranges are combined with merge
+    class MatchCount {
+    public:
+        // Lines [startLine, endLine] split into numBuckets ranges, 0 for no histogram
+        bool initialize(unsigned long long startLine, unsigned long long endLine, unsigned int numBuckets);
+        void clear();
+
+        void add(unsigned long long lineNum);
+        // Adds the matches of other, which has the same range and counted lines after the ones of this count
+        void merge(const MatchCount& other);
+
+        unsigned long long getNumMatches() const;
+        unsigned long long getFirstLine() const; // 0 if there are no matches
+        unsigned long long getLastLine() const;
+        unsigned long long getBucketNumLines() const;
+        const std::vector<unsigned long long>& getBuckets() const;
+
+    private:
+        void touch(size_t begin, size_t end);
+
+        unsigned long long _startLine = 0;
+        unsigned long long _bucketNumLines = 0;
+        unsigned long long _numMatches = 0;
+        unsigned long long _firstLine = 0;
+        unsigned long long _lastLine = 0;
+        std::vector<unsigned long long> _buckets;
+        // buckets [_touchedBegin, _touchedEnd) may be non-zero, so that a count over one chunk of a large range
+        // is cleared and merged without walking every bucket
+        size_t _touchedBegin = 0;
+        size_t _touchedEnd = 0;
+    };
+}
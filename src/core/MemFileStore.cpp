@@ -0,0 +1,58 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemFileStore.h"
+
+namespace PLP {
+    std::mutex MemFileStore::_accessLock;
+    std::unordered_map<std::wstring, std::shared_ptr<std::vector<char>>> MemFileStore::_files;
+
+    std::shared_ptr<std::vector<char>> MemFileStore::create(const std::wstring& path) {
+        std::lock_guard<std::mutex> lock(_accessLock);
+        try {
+            std::shared_ptr<std::vector<char>> file = std::make_shared<std::vector<char>>();
+            _files[path] = file;
+            return file;
+        } catch (std::bad_alloc&) {
+            return nullptr;
+        }
+    }
+
+    std::shared_ptr<std::vector<char>> MemFileStore::get(const std::wstring& path) {
+        std::lock_guard<std::mutex> lock(_accessLock);
+        auto it = _files.find(path);
+        if (it == _files.end()) {
+            return nullptr;
+        }
+        return it->second;
+    }
+
+    bool MemFileStore::contains(const std::wstring& path) {
+        std::lock_guard<std::mutex> lock(_accessLock);
+        return _files.find(path) != _files.end();
+    }
+
+    void MemFileStore::remove(const std::wstring& path) {
+        std::lock_guard<std::mutex> lock(_accessLock);
+        _files.erase(path);
+    }
+
+    void MemFileStore::clear() {
+        std::lock_guard<std::mutex> lock(_accessLock);
+        _files.clear();
+    }
+}
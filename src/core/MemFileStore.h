@@ -0,0 +1,44 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+namespace PLP {
+    // Contents of in-memory index files, found by the path they would have on disk
+    class MemFileStore {
+    public:
+        static std::shared_ptr<std::vector<char>> create(const std::wstring& path);
+        static std::shared_ptr<std::vector<char>> get(const std::wstring& path);
+        static bool contains(const std::wstring& path);
+        static void remove(const std::wstring& path);
+        static void clear();
+
+    private:
+        MemFileStore() = delete;
+        MemFileStore(const MemFileStore&) = delete;
+        MemFileStore& operator=(const MemFileStore&) = delete;
+
+        static std::mutex _accessLock;
+        static std::unordered_map<std::wstring, std::shared_ptr<std::vector<char>>> _files;
+    };
+}
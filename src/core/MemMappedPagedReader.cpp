@@ -16,24 +16,44 @@
  */
 
 #include "MemMappedPagedReader.h"
+#include "Utils.h"
 
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
 
 namespace PLP {
     MemMappedPagedReader::MemMappedPagedReader() {}
     MemMappedPagedReader::~MemMappedPagedReader() {
-        if (_fileHandle) {
+        unmapView();
+
+#ifdef _WIN32
+        if (_fileMappingHandle) {
+            CloseHandle(_fileMappingHandle);
+        }
+        if (_fileHandle && _fileHandle != INVALID_HANDLE_VALUE) {
             CloseHandle(_fileHandle);
         }
+#else
+        if (_fileDescriptor >= 0) {
+            close(_fileDescriptor);
+        }
+#endif
     }
 
     bool MemMappedPagedReader::initialize(const std::wstring& path, unsigned long long preferredBuffSize) {
         _filePath = path;
 
+#ifdef _WIN32
         _fileHandle = CreateFileW(
             path.c_str(), 
             GENERIC_READ, 
-            0, 
+            FILE_SHARE_READ, // other readers of the same file may be open at the same time
             NULL, 
             OPEN_EXISTING, 
             FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, //https://blogs.msdn.microsoft.com/oldnewthing/20120120-00/?p=8493
@@ -41,7 +61,6 @@ namespace PLP {
         );
 
         if (_fileHandle == INVALID_HANDLE_VALUE) {
-            DWORD err = GetLastError();
             return false;
         }
 
@@ -68,6 +87,28 @@ namespace PLP {
             return false;
         }
 
+        SYSTEM_INFO sysInfo;
+        GetSystemInfo(&sysInfo);
+        _allocGranularity = sysInfo.dwAllocationGranularity;
+#else
+        _fileDescriptor = open(wstring_to_string(path).c_str(), O_RDONLY);
+        if (_fileDescriptor < 0) {
+            return false;
+        }
+
+        struct stat fileStat;
+        if (fstat(_fileDescriptor, &fileStat) != 0) {
+            return false;
+        }
+        _fileSize = fileStat.st_size;
+
+        long pageSize = sysconf(_SC_PAGESIZE);
+        if (pageSize <= 0) {
+            return false;
+        }
+        _allocGranularity = pageSize;
+#endif
+
         unsigned long long unadjustedBuffSize;
         if (preferredBuffSize > 0) {
             if (preferredBuffSize <= MAX_PAGE_SIZE_BYTES && _fileSize <= preferredBuffSize) {
@@ -85,10 +126,6 @@ namespace PLP {
             }
         }
 
-        SYSTEM_INFO sysInfo;
-        GetSystemInfo(&sysInfo);
-        _allocGranularity = sysInfo.dwAllocationGranularity;
-
         if (unadjustedBuffSize <= _allocGranularity) {
             _buffSize = _allocGranularity;
         } else {
@@ -105,14 +142,31 @@ namespace PLP {
             return nullptr;
         }
 
-        if (_data) {
-            bool status = UnmapViewOfFile(_data);
-            DWORD err = GetLastError();
+        // slide the window only when the requested offset is outside of the current view,
+        // or when too little of the view is left to be useful
+        const unsigned long long dataEnd = _dataFileOffset + _dataSize;
+        const bool inView = _data && fileOffset >= _dataFileOffset && fileOffset < dataEnd;
+        if (!inView || (dataEnd < _fileSize && dataEnd - fileOffset < _buffSize / 2)) {
+            // the view is extended by the alignment so that a full buffer follows the requested offset
+            unsigned long long alignedOffset = fileOffset / _allocGranularity * _allocGranularity;
+            unsigned long long bytesTillEnd = _fileSize - alignedOffset;
+            unsigned long long viewSize = _buffSize + (fileOffset - alignedOffset);
+            unsigned long long bytesToRead = bytesTillEnd > viewSize ? viewSize : bytesTillEnd;
+
+            if (!mapView(alignedOffset, bytesToRead)) {
+                return nullptr;
+            }
         }
 
-        unsigned long long alignedOffset = fileOffset / _allocGranularity * _allocGranularity;
-        unsigned long long bytesTillEnd = _fileSize - alignedOffset;
-        unsigned long long bytesToRead = bytesTillEnd > _buffSize ? _buffSize : bytesTillEnd;
+        unsigned long long deltaOffset = fileOffset - _dataFileOffset;
+        size = _dataSize - deltaOffset;
+        return (const char*)_data + deltaOffset;
+    }
+
+    bool MemMappedPagedReader::mapView(unsigned long long alignedOffset, unsigned long long size) {
+        unmapView();
+
+#ifdef _WIN32
         DWORD high = static_cast<DWORD>((alignedOffset >> 32) & 0xFFFFFFFFul);
         DWORD low = static_cast<DWORD>(alignedOffset & 0xFFFFFFFFul);
 
@@ -121,18 +175,42 @@ namespace PLP {
             FILE_MAP_READ,
             high,
             low,
-            bytesToRead
+            size
         );
 
         if (_data == nullptr) {
-            DWORD err = GetLastError();
-            printf("Failed during mapping: %i", err);
-            return nullptr;
+            return false;
         }
+#else
+        void* data = mmap(nullptr, size, PROT_READ, MAP_SHARED, _fileDescriptor, (off_t)alignedOffset);
+        if (data == MAP_FAILED) {
+            return false;
+        }
+        _data = data;
 
-        unsigned long long deltaOffset = fileOffset - alignedOffset;
-        size = bytesToRead - deltaOffset;
-        return (const char*)_data + deltaOffset;
+        // pages are consumed front to back; let the kernel read ahead aggressively and start loading the head of the view
+        madvise(_data, size, MADV_SEQUENTIAL);
+        madvise(_data, size > PREFETCH_SIZE_BYTES ? PREFETCH_SIZE_BYTES : size, MADV_WILLNEED);
+#endif
+
+        _dataFileOffset = alignedOffset;
+        _dataSize = size;
+        return true;
+    }
+
+    void MemMappedPagedReader::unmapView() {
+        if (!_data) {
+            return;
+        }
+
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+#else
+        munmap(_data, _dataSize);
+#endif
+        _data = nullptr;
+        _dataFileOffset = 0;
+        _dataSize = 0;
     }
 
     unsigned long long MemMappedPagedReader::getFileSize() {
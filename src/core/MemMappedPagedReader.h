@@ -35,10 +35,20 @@ namespace PLP {
         const std::wstring& getFilePath();
     private:
         static const unsigned long long MAX_PAGE_SIZE_BYTES = 1073741824; //1 GB
+        static const unsigned long long PREFETCH_SIZE_BYTES = 4194304; //4 MB
 
+        bool mapView(unsigned long long alignedOffset, unsigned long long size);
+        void unmapView();
+
+#ifdef _WIN32
         void* _fileHandle = nullptr;
         void* _fileMappingHandle = nullptr;
+#else
+        int _fileDescriptor = -1;
+#endif
         void* _data = nullptr;
+        unsigned long long _dataFileOffset = 0; // file offset of the currently mapped window
+        unsigned long long _dataSize = 0;
 
         std::wstring _filePath;
         unsigned long long _fileSize = 0;
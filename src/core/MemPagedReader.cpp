@@ -0,0 +1,51 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemPagedReader.h"
+
+namespace PLP {
+    MemPagedReader::MemPagedReader() {}
+    MemPagedReader::~MemPagedReader() {}
+
+    bool MemPagedReader::initialize(const std::wstring& path, std::shared_ptr<std::vector<char>> data) {
+        if (!data) {
+            return false;
+        }
+        _data = data;
+        _filePath = path;
+        return true;
+    }
+
+    const char* MemPagedReader::read(unsigned long long fileOffset, unsigned long long& size) {
+        size = 0;
+
+        if (fileOffset >= _data->size()) {
+            return nullptr;
+        }
+
+        size = _data->size() - fileOffset;
+        return _data->data() + fileOffset;
+    }
+
+    unsigned long long MemPagedReader::getFileSize() {
+        return _data->size();
+    }
+
+    const std::wstring& MemPagedReader::getFilePath() {
+        return _filePath;
+    }
+}
@@ -0,0 +1,40 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PagedReader.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace PLP {
+    class MemPagedReader : public PagedReader {
+    public:
+        MemPagedReader();
+        ~MemPagedReader();
+
+        bool initialize(const std::wstring& path, std::shared_ptr<std::vector<char>> data);
+        const char* read(unsigned long long fileOffset, unsigned long long& size);
+        unsigned long long getFileSize();
+        const std::wstring& getFilePath();
+    private:
+        std::shared_ptr<std::vector<char>> _data;
+        std::wstring _filePath;
+    };
+}
@@ -0,0 +1,133 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MemPagedWriter.h"
+#include "MemFileStore.h"
+#include "FStreamPagedWriter.h"
+#include "GenFileTracker.h"
+#include "Logger.h"
+#include "Utils.h"
+
+#include <fstream>
+#include <cstring>
+#include <climits>
+
+namespace PLP {
+    MemPagedWriter::MemPagedWriter() {}
+    MemPagedWriter::~MemPagedWriter() {}
+
+    bool MemPagedWriter::initialize(
+        const std::wstring& path,
+        unsigned long long memoryBudgetBytes,
+        unsigned long long preferredBuffSize,
+        bool overwriteIfExists,
+        TaskRunner& asyncTaskRunner) {
+        _path = path;
+        _memoryBudgetBytes = memoryBudgetBytes > 0 ? memoryBudgetBytes : ULLONG_MAX;
+        _preferredBuffSize = preferredBuffSize;
+        _asyncTaskRunner = &asyncTaskRunner;
+
+        if (!overwriteIfExists) {
+            std::fstream fs;
+            fs.open(path, std::fstream::in | std::fstream::binary); //check file existence
+            if (fs.good() || MemFileStore::contains(path)) {
+                return false;
+            }
+        }
+
+        _data = MemFileStore::create(path);
+        return _data != nullptr;
+    }
+
+    bool MemPagedWriter::write(const char* data, unsigned long long size) {
+        if (_spillWriter) {
+            return _spillWriter->write(data, size);
+        }
+        if (!data || size == 0) {
+            return false;
+        }
+
+        if (_position + size > _memoryBudgetBytes) {
+            if (!spill()) {
+                return false;
+            }
+            return _spillWriter->write(data, size);
+        }
+
+        try {
+            if (_position + size > _data->size()) {
+                _data->resize((size_t)(_position + size));
+            }
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+
+        memcpy(_data->data() + _position, data, (size_t)size);
+        _position += size;
+        return true;
+    }
+
+    bool MemPagedWriter::flush() {
+        if (_spillWriter) {
+            return _spillWriter->flush();
+        }
+        return true;
+    }
+
+    bool MemPagedWriter::setPosition(unsigned long long fileOffset) {
+        if (_spillWriter) {
+            return _spillWriter->setPosition(fileOffset);
+        }
+
+        if (fileOffset > _data->size()) {
+            return false;
+        }
+        _position = fileOffset;
+        return true;
+    }
+
+    bool MemPagedWriter::setPositionEnd() {
+        if (_spillWriter) {
+            return _spillWriter->setPositionEnd();
+        }
+
+        _position = _data->size();
+        return true;
+    }
+
+    bool MemPagedWriter::spill() {
+        Logger::send(INFO, "Index " + wstring_to_string(_path) + " exceeded its memory budget, moving it to disk");
+
+        std::unique_ptr<FStreamPagedWriter> spillWriter(new FStreamPagedWriter());
+        if (!spillWriter->initialize(_path, _preferredBuffSize, true, *_asyncTaskRunner)) {
+            return false;
+        }
+        LC::GenFileTracker::addFile(_path);
+
+        if (!_data->empty() && !spillWriter->write(_data->data(), _data->size())) {
+            return false;
+        }
+        if (!spillWriter->setPosition(_position)) {
+            return false;
+        }
+        _spillWriter = std::move(spillWriter);
+
+        MemFileStore::remove(_path);
+        _data = nullptr;
+        return true;
+    }
+}
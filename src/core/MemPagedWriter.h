@@ -0,0 +1,60 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "PagedWriter.h"
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace PLP {
+    class TaskRunner;
+    class FStreamPagedWriter;
+
+    // Writes to a file of MemFileStore. Once the file outgrows its memory budget it is moved to disk
+    // and the rest is written through an FStreamPagedWriter
+    class MemPagedWriter : public PagedWriter {
+    public:
+        MemPagedWriter();
+        ~MemPagedWriter();
+
+        bool initialize(
+            const std::wstring& path,
+            unsigned long long memoryBudgetBytes, //0 for no limit
+            unsigned long long preferredBuffSize,
+            bool overwriteIfExists,
+            TaskRunner& asyncTaskRunner
+        );
+        bool write(const char* data, unsigned long long size);
+        bool setPosition(unsigned long long fileOffset);
+        bool setPositionEnd();
+        bool flush();
+    private:
+        bool spill();
+
+        std::wstring _path;
+        std::shared_ptr<std::vector<char>> _data;
+        unsigned long long _position = 0;
+        unsigned long long _memoryBudgetBytes = 0;
+        unsigned long long _preferredBuffSize = 0;
+        TaskRunner* _asyncTaskRunner = nullptr;
+
+        std::unique_ptr<FStreamPagedWriter> _spillWriter;
+    };
+}
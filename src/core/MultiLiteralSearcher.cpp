@@ -0,0 +1,179 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "MultiLiteralSearcher.h"
+#include "ByteSearch.h"
+
+#include <limits>
+#include <queue>
+
+namespace PLP {
+    bool MultiLiteralSearcher::initialize(const std::vector<std::string>& needles) {
+        _single = false;
+        _matchesEmpty = false;
+        _empty = needles.empty();
+        _transitions.clear();
+        _accepting.clear();
+
+        for (auto& needle : needles) {
+            if (needle.empty()) {
+                _matchesEmpty = true;
+                return true;
+            }
+        }
+
+        if (needles.size() == 1) {
+            _single = true;
+            return _singleSearcher.initialize(needles[0]);
+        }
+
+        try {
+            return buildAutomaton(needles);
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+    }
+
+    bool MultiLiteralSearcher::containsAny(const char* data, unsigned int size) const {
+        if (_matchesEmpty) {
+            return true;
+        }
+        if (_empty) {
+            return false;
+        }
+        if (_single) {
+            return _singleSearcher.find(data, size) != nullptr;
+        }
+
+        const unsigned int* transitions = _transitions.data();
+        const unsigned char* accepting = _accepting.data();
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        unsigned int state = 0;
+        for (unsigned int i = 0; i < size; i++) {
+            if (state == 0) {
+                if (_onlyStartByte >= 0) {
+                    const char* next = findByte(data + i, data + size, (char)_onlyStartByte);
+                    i = (unsigned int)(next - data);
+                } else {
+                    while (i < size && !_startBytes[bytes[i]]) {
+                        i++;
+                    }
+                }
+                if (i == size) {
+                    return false;
+                }
+            }
+            state = transitions[state * _numClasses + _byteClasses[bytes[i]]];
+            if (accepting[state]) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool MultiLiteralSearcher::buildAutomaton(const std::vector<std::string>& needles) {
+        // bytes that never appear in a needle all share class 0 and always lead back to the root
+        for (unsigned int i = 0; i < 256; i++) {
+            _byteClasses[i] = 0;
+            _startBytes[i] = false;
+        }
+        _numClasses = 1;
+        unsigned int numStartBytes = 0;
+        for (auto& needle : needles) {
+            unsigned char startByte = (unsigned char)needle[0];
+            if (!_startBytes[startByte]) {
+                _startBytes[startByte] = true;
+                _onlyStartByte = startByte;
+                numStartBytes++;
+            }
+
+            for (char c : needle) {
+                unsigned short& byteClass = _byteClasses[(unsigned char)c];
+                if (byteClass == 0) {
+                    byteClass = (unsigned short)_numClasses++;
+                }
+            }
+        }
+        if (numStartBytes != 1) {
+            _onlyStartByte = -1;
+        }
+
+        const unsigned int noState = std::numeric_limits<unsigned int>::max();
+        unsigned long long numStates = 1;
+        for (auto& needle : needles) {
+            numStates += needle.size();
+        }
+        if (numStates * _numClasses >= noState) {
+            return false;
+        }
+        _transitions.reserve((size_t)(numStates * _numClasses));
+
+        // trie
+        _transitions.assign(_numClasses, noState);
+        _accepting.assign(1, 0);
+        for (auto& needle : needles) {
+            unsigned int state = 0;
+            for (char c : needle) {
+                unsigned int& next = _transitions[state * _numClasses + _byteClasses[(unsigned char)c]];
+                if (next == noState) {
+                    next = (unsigned int)_accepting.size();
+                    _transitions.insert(_transitions.end(), _numClasses, noState);
+                    _accepting.push_back(0);
+                    state = (unsigned int)_accepting.size() - 1;
+                } else {
+                    state = next;
+                }
+            }
+            _accepting[state] = 1;
+        }
+
+        // failure links, breadth first. Missing edges are replaced with the edge of the failure state,
+        // which turns the trie into a DFA. A state accepts if any of its suffixes does
+        std::vector<unsigned int> failure(_accepting.size(), 0);
+        std::queue<unsigned int> pending;
+        for (unsigned int c = 0; c < _numClasses; c++) {
+            unsigned int& next = _transitions[c];
+            if (next == noState) {
+                next = 0;
+            } else {
+                failure[next] = 0;
+                pending.push(next);
+            }
+        }
+
+        while (!pending.empty()) {
+            const unsigned int state = pending.front();
+            pending.pop();
+            const unsigned int fail = failure[state];
+            if (_accepting[fail]) {
+                _accepting[state] = 1;
+            }
+
+            for (unsigned int c = 0; c < _numClasses; c++) {
+                unsigned int& next = _transitions[state * _numClasses + c];
+                const unsigned int failNext = _transitions[fail * _numClasses + c];
+                if (next == noState) {
+                    next = failNext;
+                } else {
+                    failure[next] = failNext;
+                    pending.push(next);
+                }
+            }
+        }
+        return true;
+    }
+}
\ No newline at end of file
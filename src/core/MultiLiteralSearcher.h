@@ -0,0 +1,52 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "LiteralSearcher.h"
+
+#include <string>
+#include <vector>
+
+namespace PLP {
+    // Checks a span of bytes for any of a set of fixed strings in a single pass. The needles are compiled into an
+    // Aho-Corasick automaton with a dense transition table over byte classes, so every input byte costs one lookup
+    // regardless of how many needles there are. While in the root state, bytes that cannot start a needle are skipped
+    // without touching the table, using findByte when all needles start with the same byte.
+    // A single needle is handed to LiteralSearcher instead
+    class MultiLiteralSearcher {
+    public:
+        bool initialize(const std::vector<std::string>& needles);
+        // Returns true if any needle occurs in data. An empty needle matches everything
+        bool containsAny(const char* data, unsigned int size) const;
+
+    private:
+        bool buildAutomaton(const std::vector<std::string>& needles);
+
+        LiteralSearcher _singleSearcher;
+        bool _single = false;
+        bool _matchesEmpty = false;
+        bool _empty = true;
+
+        unsigned short _byteClasses[256];
+        bool _startBytes[256];
+        int _onlyStartByte = -1;
+        unsigned int _numClasses = 0;
+        std::vector<unsigned int> _transitions;
+        std::vector<unsigned char> _accepting;
+    };
+}
\ No newline at end of file
@@ -26,5 +26,9 @@ namespace PLP {
         virtual const char* read(unsigned long long fileOffset, unsigned long long& size) = 0;
         virtual unsigned long long getFileSize() = 0;
         virtual const std::wstring& getFilePath() = 0;
+
+        // Hint that the data at fileOffset will be read soon. Readers that can load pages asynchronously
+        // start loading it in the background, others ignore the hint
+        virtual void prefetch(unsigned long long fileOffset) {}
     };
 }
\ No newline at end of file
@@ -0,0 +1,145 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ParallelScanner.h"
+#include "ThreadPool.h"
+
+namespace PLP {
+    ParallelScanner::ParallelScanner(
+        FileReaderI* fileReader, 
+        ThreadPool* workerPool, 
+        unsigned int numSlots, 
+        unsigned long long startLine, 
+        unsigned long long endLine
+    ) : _fileReader(fileReader), _workerPool(workerPool), _numSlots(numSlots), _startLine(startLine), _endLine(endLine) {
+        _stop = false;
+    }
+
+    ParallelScanner::~ParallelScanner() {
+        _stop = true;
+        waitForSlots();
+    }
+
+    bool ParallelScanner::initialize() {
+        if (!_fileReader || !_workerPool || _numSlots == 0 || _startLine > _endLine) {
+            return false;
+        }
+
+        const unsigned long long numChunks = _endLine / CHUNK_NUM_LINES - _startLine / CHUNK_NUM_LINES + 1;
+        if (_numSlots > numChunks) {
+            _numSlots = (unsigned int)numChunks;
+        }
+
+        try {
+            for (unsigned int i = 0; i < _numSlots; i++) {
+                std::unique_ptr<Slot> slot(new Slot());
+                slot->fileReader.reset(_fileReader->clone());
+                if (!slot->fileReader) {
+                    return false;
+                }
+                _slots.push_back(std::move(slot));
+            }
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+
+        return true;
+    }
+
+    unsigned int ParallelScanner::getNumSlots() const {
+        return _numSlots;
+    }
+
+    bool ParallelScanner::run(const ChunkTask& task, const ChunkMerge& merge, const std::atomic<bool>& cancelled) {
+        const unsigned long long firstChunk = _startLine / CHUNK_NUM_LINES;
+        const unsigned long long numChunks = _endLine / CHUNK_NUM_LINES - firstChunk + 1;
+
+        auto chunkStartLine = [&](unsigned long long chunkNum) {
+            const unsigned long long start = (firstChunk + chunkNum) * CHUNK_NUM_LINES;
+            return start > _startLine ? start : _startLine;
+        };
+        auto chunkEndLine = [&](unsigned long long chunkNum) {
+            const unsigned long long end = (firstChunk + chunkNum + 1) * CHUNK_NUM_LINES - 1;
+            return end < _endLine ? end : _endLine;
+        };
+
+        auto scheduleChunk = [&](unsigned long long chunkNum) {
+            const unsigned int slotIndex = (unsigned int)(chunkNum % _numSlots);
+            Slot* slot = _slots[slotIndex].get();
+            const unsigned long long start = chunkStartLine(chunkNum);
+            const unsigned long long end = chunkEndLine(chunkNum);
+            _workerPool->runAsync([this, &task, slot, slotIndex, start, end]() {
+                slot->fileReader->restart();
+                slot->result = task(slotIndex, slot->fileReader.get(), start, end, _stop);
+            }, slot->status);
+        };
+
+        _stop = false;
+        for (unsigned long long chunkNum = 0; chunkNum < _numSlots; chunkNum++) {
+            scheduleChunk(chunkNum);
+        }
+
+        bool succeeded = true;
+        for (unsigned long long chunkNum = 0; chunkNum < numChunks; chunkNum++) {
+            const unsigned int slotIndex = (unsigned int)(chunkNum % _numSlots);
+            Slot& slot = *_slots[slotIndex];
+            _workerPool->wait(slot.status, cancelled);
+            if (cancelled || slot.result == LineReaderResult::ERROR) {
+                succeeded = false;
+                break;
+            }
+
+            if (!merge(slotIndex, chunkEndLine(chunkNum))) {
+                break;
+            }
+
+            if (chunkNum + _numSlots < numChunks) {
+                scheduleChunk(chunkNum + _numSlots);
+            }
+        }
+
+        // tasks reference the slots and the caller's state
+        _stop = true;
+        waitForSlots();
+        return succeeded;
+    }
+
+    void ParallelScanner::waitForSlots() {
+        const std::atomic<bool> notCancelled(false);
+        for (auto& slot : _slots) {
+            _workerPool->wait(slot->status, notCancelled);
+        }
+    }
+
+    void CollectedLines::clear() {
+        _lines.clear();
+        _data.clear();
+    }
+
+    void CollectedLines::add(unsigned long long lineNum, unsigned long long fileOffset, const char* data, unsigned int size) {
+        _lines.push_back({ lineNum, fileOffset, _data.size(), size });
+        _data.insert(_data.end(), data, data + size);
+    }
+
+    const std::vector<CollectedLines::Line>& CollectedLines::getLines() const {
+        return _lines;
+    }
+
+    const char* CollectedLines::getData(const Line& line) const {
+        return _data.data() + line.dataOffset;
+    }
+}
\ No newline at end of file
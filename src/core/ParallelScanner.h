@@ -0,0 +1,98 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "FileReaderI.h"
+#include "TaskRunner.h"
+
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <functional>
+
+namespace PLP {
+    class ThreadPool;
+
+    // Splits a range of lines into chunks aligned to the line index and scans them on a thread pool.
+    // Every slot owns a clone of the file reader and works on one chunk at a time. Chunk results are
+    // merged on the calling thread in line order
+    class ParallelScanner {
+    public:
+        // Scans lines [startLine, endLine] with the reader of the given slot. Runs on a worker thread and should
+        // return early once stop is set
+        typedef std::function<LineReaderResult(
+            unsigned int slot, 
+            FileReaderI* fileReader, 
+            unsigned long long startLine, 
+            unsigned long long endLine, 
+            const std::atomic<bool>& stop
+        )> ChunkTask;
+
+        // Called on the calling thread in chunk order once the chunk task of the slot is done. Return false to stop
+        typedef std::function<bool(unsigned int slot, unsigned long long endLine)> ChunkMerge;
+
+        ParallelScanner(FileReaderI* fileReader, ThreadPool* workerPool, unsigned int numSlots, unsigned long long startLine, unsigned long long endLine);
+        ~ParallelScanner();
+
+        bool initialize();
+        unsigned int getNumSlots() const;
+
+        // Returns false if a chunk failed or if the scan was cancelled
+        bool run(const ChunkTask& task, const ChunkMerge& merge, const std::atomic<bool>& cancelled);
+
+        // a multiple of the line index frequency, so that chunks start on an indexed line
+        static const unsigned long long CHUNK_NUM_LINES = 64000;
+    private:
+        struct Slot {
+            std::unique_ptr<FileReaderI> fileReader;
+            LineReaderResult result = LineReaderResult::SUCCESS;
+            TaskStatus status;
+        };
+
+        void waitForSlots();
+
+        FileReaderI* _fileReader = nullptr;
+        ThreadPool* _workerPool = nullptr;
+        unsigned int _numSlots = 0;
+        unsigned long long _startLine = 0;
+        unsigned long long _endLine = 0;
+
+        std::vector<std::unique_ptr<Slot>> _slots;
+        std::atomic<bool> _stop;
+    };
+
+    // Lines copied out of a chunk, so that they stay valid after the reader of the chunk has moved on
+    class CollectedLines {
+    public:
+        struct Line {
+            unsigned long long lineNum;
+            unsigned long long fileOffset;
+            size_t dataOffset;
+            unsigned int size;
+        };
+
+        void clear();
+        void add(unsigned long long lineNum, unsigned long long fileOffset, const char* data, unsigned int size);
+        const std::vector<Line>& getLines() const;
+        const char* getData(const Line& line) const;
+
+    private:
+        std::vector<Line> _lines;
+        std::vector<char> _data;
+    };
+}
\ No newline at end of file
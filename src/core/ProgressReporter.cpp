@@ -60,6 +60,10 @@ namespace LC {
         }
     }
 
+    bool ProgressReporter::isUpdateDue(unsigned long long current) const {
+        return _progressUpdate && current >= _numTillNextProgressUpdate;
+    }
+
     int ProgressReporter::getCurrentPercent() {
         return _currPercent;
     }
@@ -31,6 +31,8 @@ namespace LC {
             const std::function<void(int percent)>* progressUpdate
         );
         void update(unsigned long long current);
+        // true if update(current) would report progress
+        bool isUpdateDue(unsigned long long current) const;
         int getCurrentPercent();
     private:
         std::function<void(int percent)>* _progressUpdate = nullptr;
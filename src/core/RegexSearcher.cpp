@@ -0,0 +1,886 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "RegexSearcher.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace PLP {
+    struct RegexNode {
+        enum Type {
+            BYTES,
+            EMPTY,
+            CONCAT,
+            ALTERNATE,
+            REPEAT,
+            BEGIN,
+            END
+        };
+
+        RegexNode(Type type) : type(type) {}
+
+        Type type;
+        std::bitset<256> bytes;
+        std::vector<std::unique_ptr<RegexNode>> children;
+        int min = 0;
+        int max = 0; // -1 is unbounded
+    };
+
+    namespace {
+        const int MAX_REPEAT = 1000;
+        const int MAX_NESTING = 500;
+        const size_t MAX_LITERAL_SET_SIZE = 64;
+        const size_t MAX_LITERAL_LENGTH = 256;
+
+        typedef std::unique_ptr<RegexNode> NodePtr;
+
+        // Recursive descent parser for the supported ECMAScript subset. Anything outside of it,
+        // as well as anything malformed, fails the parse
+        class RegexParser {
+        public:
+            RegexParser(const std::string& pattern, bool ignoreCase) : _pattern(pattern), _ignoreCase(ignoreCase) {}
+
+            NodePtr parse() {
+                NodePtr node = parseAlternation(0);
+                if (!node || _pos != _pattern.size()) {
+                    return nullptr;
+                }
+                return node;
+            }
+
+        private:
+            bool atEnd() const {
+                return _pos >= _pattern.size();
+            }
+
+            char peek() const {
+                return _pattern[_pos];
+            }
+
+            NodePtr parseAlternation(int depth) {
+                if (depth > MAX_NESTING) {
+                    return nullptr;
+                }
+
+                NodePtr first = parseConcat(depth);
+                if (!first) {
+                    return nullptr;
+                }
+                if (atEnd() || peek() != '|') {
+                    return first;
+                }
+
+                NodePtr alternation(new RegexNode(RegexNode::ALTERNATE));
+                alternation->children.push_back(std::move(first));
+                while (!atEnd() && peek() == '|') {
+                    _pos++;
+                    NodePtr branch = parseConcat(depth);
+                    if (!branch) {
+                        return nullptr;
+                    }
+                    alternation->children.push_back(std::move(branch));
+                }
+                return alternation;
+            }
+
+            NodePtr parseConcat(int depth) {
+                NodePtr concat(new RegexNode(RegexNode::CONCAT));
+                while (!atEnd() && peek() != '|' && peek() != ')') {
+                    NodePtr node = parseRepeat(depth);
+                    if (!node) {
+                        return nullptr;
+                    }
+                    concat->children.push_back(std::move(node));
+                }
+
+                if (concat->children.empty()) {
+                    return NodePtr(new RegexNode(RegexNode::EMPTY));
+                }
+                if (concat->children.size() == 1) {
+                    return std::move(concat->children[0]);
+                }
+                return concat;
+            }
+
+            NodePtr parseRepeat(int depth) {
+                NodePtr atom = parseAtom(depth);
+                if (!atom || atEnd()) {
+                    return atom;
+                }
+
+                int min;
+                int max;
+                char c = peek();
+                if (c == '*') {
+                    min = 0;
+                    max = -1;
+                    _pos++;
+                } else if (c == '+') {
+                    min = 1;
+                    max = -1;
+                    _pos++;
+                } else if (c == '?') {
+                    min = 0;
+                    max = 1;
+                    _pos++;
+                } else if (c == '{') {
+                    _pos++;
+                    if (!parseNumber(min)) {
+                        return nullptr;
+                    }
+                    max = min;
+                    if (!atEnd() && peek() == ',') {
+                        _pos++;
+                        if (!atEnd() && peek() == '}') {
+                            max = -1;
+                        } else if (!parseNumber(max) || max < min) {
+                            return nullptr;
+                        }
+                    }
+                    if (atEnd() || peek() != '}') {
+                        return nullptr;
+                    }
+                    _pos++;
+                } else {
+                    return atom;
+                }
+
+                // lazy quantifiers don't change whether a line matches
+                if (!atEnd() && peek() == '?') {
+                    _pos++;
+                }
+                if (!atEnd() && (peek() == '*' || peek() == '+' || peek() == '?' || peek() == '{')) {
+                    return nullptr;
+                }
+                if (atom->type == RegexNode::BEGIN || atom->type == RegexNode::END) {
+                    return nullptr;
+                }
+
+                NodePtr repeat(new RegexNode(RegexNode::REPEAT));
+                repeat->min = min;
+                repeat->max = max;
+                repeat->children.push_back(std::move(atom));
+                return repeat;
+            }
+
+            bool parseNumber(int& value) {
+                value = 0;
+                size_t start = _pos;
+                while (!atEnd() && peek() >= '0' && peek() <= '9') {
+                    value = value * 10 + (peek() - '0');
+                    if (value > MAX_REPEAT) {
+                        return false;
+                    }
+                    _pos++;
+                }
+                return _pos > start;
+            }
+
+            NodePtr parseAtom(int depth) {
+                char c = peek();
+                _pos++;
+                switch (c) {
+                case '(': {
+                    if (!atEnd() && peek() == '?') {
+                        if (_pos + 1 >= _pattern.size() || _pattern[_pos + 1] != ':') {
+                            return nullptr; // lookahead
+                        }
+                        _pos += 2;
+                    }
+                    NodePtr node = parseAlternation(depth + 1);
+                    if (!node || atEnd() || peek() != ')') {
+                        return nullptr;
+                    }
+                    _pos++;
+                    return node;
+                }
+                case '[':
+                    return parseClass();
+                case '.': {
+                    NodePtr node(new RegexNode(RegexNode::BYTES));
+                    node->bytes.set();
+                    node->bytes.reset('\n');
+                    node->bytes.reset('\r');
+                    return node;
+                }
+                case '^':
+                    return NodePtr(new RegexNode(RegexNode::BEGIN));
+                case '$':
+                    return NodePtr(new RegexNode(RegexNode::END));
+                case '\\': {
+                    std::bitset<256> bytes;
+                    if (!parseEscape(false, bytes)) {
+                        return nullptr;
+                    }
+                    return makeBytes(bytes, false);
+                }
+                case '*':
+                case '+':
+                case '?':
+                case '{':
+                case '}':
+                case ']':
+                case ')':
+                    return nullptr;
+                default: {
+                    std::bitset<256> bytes;
+                    bytes.set((unsigned char)c);
+                    return makeBytes(bytes, false);
+                }
+                }
+            }
+
+            NodePtr parseClass() {
+                bool negate = false;
+                if (!atEnd() && peek() == '^') {
+                    negate = true;
+                    _pos++;
+                }
+
+                std::bitset<256> bytes;
+                while (!atEnd() && peek() != ']') {
+                    int low;
+                    if (!parseClassAtom(bytes, low)) {
+                        return nullptr;
+                    }
+                    if (low < 0 || _pos + 1 >= _pattern.size() || peek() != '-' || _pattern[_pos + 1] == ']') {
+                        continue;
+                    }
+
+                    _pos++;
+                    int high;
+                    std::bitset<256> ignored;
+                    if (!parseClassAtom(ignored, high) || high < 0 || high < low) {
+                        return nullptr;
+                    }
+                    for (int i = low; i <= high; i++) {
+                        bytes.set(i);
+                    }
+                }
+                if (atEnd()) {
+                    return nullptr;
+                }
+                _pos++;
+
+                return makeBytes(bytes, negate);
+            }
+
+            // Adds the next class member to bytes. value is set to the byte if it is a single one that can start or end a range
+            bool parseClassAtom(std::bitset<256>& bytes, int& value) {
+                value = -1;
+                char c = peek();
+                _pos++;
+                if ((unsigned char)c >= 0x80) {
+                    return false; // multibyte characters in classes are up to the locale, leave them to std::regex
+                }
+                if (c != '\\') {
+                    bytes.set((unsigned char)c);
+                    value = (unsigned char)c;
+                    return true;
+                }
+
+                std::bitset<256> escaped;
+                if (!parseEscape(true, escaped)) {
+                    return false;
+                }
+                if (escaped.count() == 1) {
+                    for (int i = 0; i < 256; i++) {
+                        if (escaped[i]) {
+                            value = i;
+                        }
+                    }
+                }
+                bytes |= escaped;
+                return true;
+            }
+
+            bool parseEscape(bool inClass, std::bitset<256>& bytes) {
+                if (atEnd()) {
+                    return false;
+                }
+
+                char c = peek();
+                _pos++;
+                switch (c) {
+                case 'd':
+                case 'D':
+                    setRange(bytes, '0', '9');
+                    break;
+                case 'w':
+                case 'W':
+                    setRange(bytes, '0', '9');
+                    setRange(bytes, 'a', 'z');
+                    setRange(bytes, 'A', 'Z');
+                    bytes.set('_');
+                    break;
+                case 's':
+                case 'S':
+                    bytes.set(' ');
+                    setRange(bytes, '\t', '\r');
+                    break;
+                case 't': bytes.set('\t'); return true;
+                case 'n': bytes.set('\n'); return true;
+                case 'r': bytes.set('\r'); return true;
+                case 'v': bytes.set('\v'); return true;
+                case 'f': bytes.set('\f'); return true;
+                case '0': bytes.set(0); return true;
+                case 'b':
+                    if (!inClass) {
+                        return false; // word boundary
+                    }
+                    bytes.set('\b');
+                    return true;
+                case 'c': {
+                    if (atEnd() || !isalpha((unsigned char)peek())) {
+                        return false;
+                    }
+                    bytes.set(peek() % 32);
+                    _pos++;
+                    return true;
+                }
+                case 'x':
+                case 'u': {
+                    int numDigits = c == 'x' ? 2 : 4;
+                    int value = 0;
+                    for (int i = 0; i < numDigits; i++) {
+                        if (atEnd() || !isxdigit((unsigned char)peek())) {
+                            return false;
+                        }
+                        char digit = (char)tolower((unsigned char)peek());
+                        value = value * 16 + (digit <= '9' ? digit - '0' : digit - 'a' + 10);
+                        _pos++;
+                    }
+                    if (value >= 0x80) {
+                        return false;
+                    }
+                    bytes.set(value);
+                    return true;
+                }
+                default:
+                    if (isalnum((unsigned char)c) || (unsigned char)c >= 0x80) {
+                        return false; // backreferences and unknown escapes
+                    }
+                    bytes.set((unsigned char)c);
+                    return true;
+                }
+
+                if (isupper((unsigned char)c)) {
+                    bytes.flip();
+                }
+                return true;
+            }
+
+            static void setRange(std::bitset<256>& bytes, int low, int high) {
+                for (int i = low; i <= high; i++) {
+                    bytes.set(i);
+                }
+            }
+
+            NodePtr makeBytes(std::bitset<256> bytes, bool negate) {
+                if (_ignoreCase) {
+                    for (int i = 'a'; i <= 'z'; i++) {
+                        if (bytes[i] || bytes[i - 'a' + 'A']) {
+                            bytes.set(i);
+                            bytes.set(i - 'a' + 'A');
+                        }
+                    }
+                }
+                if (negate) {
+                    bytes.flip();
+                }
+
+                NodePtr node(new RegexNode(RegexNode::BYTES));
+                node->bytes = bytes;
+                return node;
+            }
+
+            const std::string& _pattern;
+            bool _ignoreCase;
+            size_t _pos = 0;
+        };
+
+        // Literal strings a node is known to produce. exact means the node matches one of exactSet and nothing else.
+        // Any match of the node contains at least one of required, unless required is empty
+        struct LiteralInfo {
+            bool exact = false;
+            std::vector<std::string> exactSet;
+            std::vector<std::string> required;
+        };
+
+        bool getLiteralByte(const std::bitset<256>& bytes, bool ignoreCase, char& c) {
+            size_t count = bytes.count();
+            if (count == 1 || (ignoreCase && count == 2)) {
+                for (int i = 0; i < 256; i++) {
+                    if (bytes[i]) {
+                        if (count == 2 && !(i >= 'A' && i <= 'Z' && bytes[i - 'A' + 'a'])) {
+                            return false;
+                        }
+                        c = count == 2 ? (char)(i - 'A' + 'a') : (char)i;
+                        return true;
+                    }
+                }
+            }
+            return false;
+        }
+
+        bool crossProduct(const std::vector<std::string>& first, const std::vector<std::string>& second, std::vector<std::string>& product) {
+            if (first.size() * second.size() > MAX_LITERAL_SET_SIZE) {
+                return false;
+            }
+
+            product.clear();
+            for (auto& head : first) {
+                for (auto& tail : second) {
+                    if (head.size() + tail.size() > MAX_LITERAL_LENGTH) {
+                        return false;
+                    }
+                    product.push_back(head + tail);
+                }
+            }
+            return true;
+        }
+
+        size_t getShortestLength(const std::vector<std::string>& literals) {
+            if (literals.empty()) {
+                return 0;
+            }
+            size_t shortest = literals[0].size();
+            for (auto& literal : literals) {
+                shortest = std::min(shortest, literal.size());
+            }
+            return shortest;
+        }
+
+        // Keeps the candidate that filters best: longest shortest string first, then fewest strings
+        void considerRequired(const std::vector<std::string>& candidate, std::vector<std::string>& best) {
+            size_t candidateLength = getShortestLength(candidate);
+            if (candidateLength == 0) {
+                return;
+            }
+            size_t bestLength = getShortestLength(best);
+            if (candidateLength > bestLength || (candidateLength == bestLength && candidate.size() < best.size())) {
+                best = candidate;
+            }
+        }
+
+        void removeDuplicates(std::vector<std::string>& literals) {
+            std::sort(literals.begin(), literals.end());
+            literals.erase(std::unique(literals.begin(), literals.end()), literals.end());
+        }
+
+        LiteralInfo analyzeLiterals(const RegexNode& node, bool ignoreCase, bool& hasAnchors) {
+            LiteralInfo info;
+            switch (node.type) {
+            case RegexNode::BYTES: {
+                char c;
+                if (getLiteralByte(node.bytes, ignoreCase, c)) {
+                    info.exact = true;
+                    info.exactSet.push_back(std::string(1, c));
+                }
+                break;
+            }
+            case RegexNode::BEGIN:
+            case RegexNode::END:
+                hasAnchors = true;
+                info.exact = true;
+                info.exactSet.push_back("");
+                break;
+            case RegexNode::EMPTY:
+                info.exact = true;
+                info.exactSet.push_back("");
+                break;
+            case RegexNode::CONCAT: {
+                std::vector<std::string> run(1, "");
+                std::vector<std::string> product;
+                bool exact = true;
+                for (auto& child : node.children) {
+                    LiteralInfo childInfo = analyzeLiterals(*child, ignoreCase, hasAnchors);
+                    if (childInfo.exact) {
+                        if (crossProduct(run, childInfo.exactSet, product)) {
+                            run.swap(product);
+                        } else {
+                            exact = false;
+                            considerRequired(run, info.required);
+                            run = childInfo.exactSet;
+                        }
+                    } else {
+                        exact = false;
+                        considerRequired(run, info.required);
+                        considerRequired(childInfo.required, info.required);
+                        run.assign(1, "");
+                    }
+                }
+                considerRequired(run, info.required);
+                if (exact) {
+                    info.exact = true;
+                    info.exactSet = run;
+                }
+                break;
+            }
+            case RegexNode::ALTERNATE: {
+                bool exact = true;
+                bool required = true;
+                for (auto& child : node.children) {
+                    LiteralInfo childInfo = analyzeLiterals(*child, ignoreCase, hasAnchors);
+                    if (childInfo.exact) {
+                        info.exactSet.insert(info.exactSet.end(), childInfo.exactSet.begin(), childInfo.exactSet.end());
+                    } else {
+                        exact = false;
+                    }
+                    if (childInfo.required.empty()) {
+                        required = false;
+                    } else {
+                        info.required.insert(info.required.end(), childInfo.required.begin(), childInfo.required.end());
+                    }
+                }
+
+                removeDuplicates(info.exactSet);
+                removeDuplicates(info.required);
+                info.exact = exact && info.exactSet.size() <= MAX_LITERAL_SET_SIZE;
+                if (!info.exact) {
+                    info.exactSet.clear();
+                }
+                if (!required || info.required.size() > MAX_LITERAL_SET_SIZE) {
+                    info.required.clear();
+                }
+                break;
+            }
+            case RegexNode::REPEAT: {
+                LiteralInfo childInfo = analyzeLiterals(*node.children[0], ignoreCase, hasAnchors);
+                if (node.max == 0) {
+                    info.exact = true;
+                    info.exactSet.push_back("");
+                    break;
+                }
+                if (node.min == 0) {
+                    break;
+                }
+
+                info.required = childInfo.required;
+                if (childInfo.exact && node.min == node.max) {
+                    std::vector<std::string> run(1, "");
+                    std::vector<std::string> product;
+                    info.exact = true;
+                    for (int i = 0; i < node.min && info.exact; i++) {
+                        info.exact = crossProduct(run, childInfo.exactSet, product);
+                        run.swap(product);
+                    }
+                    if (info.exact) {
+                        info.exactSet = run;
+                    }
+                }
+                break;
+            }
+            }
+
+            if (info.exact) {
+                removeDuplicates(info.exactSet);
+                considerRequired(info.exactSet, info.required);
+            }
+            return info;
+        }
+    }
+
+    bool RegexSearcher::initialize(const std::string& pattern, bool ignoreCase) {
+        _nfa.clear();
+        _byteSets.clear();
+        _dfa.clear();
+        _dfaIndex.clear();
+        _prefilter = PREFILTER_NONE;
+        _literalOnly = false;
+
+        try {
+            RegexParser parser(pattern, ignoreCase);
+            NodePtr root = parser.parse();
+            if (!root) {
+                return false;
+            }
+
+            bool hasAnchors = false;
+            LiteralInfo literals = analyzeLiterals(*root, ignoreCase, hasAnchors);
+            if (literals.required.size() == 1) {
+                if (!_literalSearcher.initialize(literals.required[0], ignoreCase)) {
+                    return false;
+                }
+                _prefilter = PREFILTER_LITERAL;
+            } else if (literals.required.size() > 1 && !ignoreCase) {
+                if (!_multiLiteralSearcher.initialize(literals.required)) {
+                    return false;
+                }
+                _prefilter = PREFILTER_MULTI_LITERAL;
+            }
+            _literalOnly = _prefilter != PREFILTER_NONE && literals.exact && !hasAnchors;
+
+            int matchState = addNfaState(NFA_MATCH, -1);
+            _startState = compile(*root, matchState);
+            if (_startState < 0) {
+                return false;
+            }
+
+            _visited.assign(_nfa.size(), 0);
+            _generation = 0;
+
+            std::vector<int> initialStates;
+            _generation++;
+            addClosure(_startState, true, false, initialStates);
+            std::sort(initialStates.begin(), initialStates.end());
+            _dfa.resize(1);
+            initDfaState(_dfa[0], initialStates, true);
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+        return true;
+    }
+
+    bool RegexSearcher::search(const char* data, unsigned int size) {
+        if (_prefilter == PREFILTER_LITERAL && _literalSearcher.find(data, size) == nullptr) {
+            return false;
+        }
+        if (_prefilter == PREFILTER_MULTI_LITERAL && !_multiLiteralSearcher.containsAny(data, size)) {
+            return false;
+        }
+        if (_literalOnly) {
+            return true;
+        }
+
+        if (_dfa.size() >= MAX_DFA_STATES) {
+            resetDfa();
+        }
+
+        const unsigned char* bytes = reinterpret_cast<const unsigned char*>(data);
+        int state = 0;
+        for (unsigned int i = 0; i < size; i++) {
+            if (_dfa[state].match) {
+                return true;
+            }
+            if (_dfa[state].dead) {
+                return false;
+            }
+
+            int next = _dfa[state].next[bytes[i]];
+            if (next < 0) {
+                try {
+                    step(_dfa[state].nfaStates, bytes[i], _stepBuffer);
+                    next = getDfaState(_stepBuffer);
+                } catch (std::bad_alloc&) {
+                    next = -1;
+                }
+                if (next < 0) {
+                    return searchNfa(_stepBuffer, bytes + i + 1, size - i - 1);
+                }
+                _dfa[state].next[bytes[i]] = next;
+            }
+            state = next;
+        }
+        return _dfa[state].match || _dfa[state].matchAtEnd;
+    }
+
+    const LiteralSearcher* RegexSearcher::getRequiredLiteral() const {
+        return _prefilter == PREFILTER_LITERAL ? &_literalSearcher : nullptr;
+    }
+
+    int RegexSearcher::compile(const RegexNode& node, int next) {
+        if (next < 0 || _nfa.size() > MAX_NFA_STATES) {
+            return -1;
+        }
+
+        switch (node.type) {
+        case RegexNode::BYTES:
+            _byteSets.push_back(node.bytes);
+            return addNfaState(NFA_BYTES, next, -1, (int)_byteSets.size() - 1);
+        case RegexNode::EMPTY:
+            return next;
+        case RegexNode::BEGIN:
+            return addNfaState(NFA_BEGIN, next);
+        case RegexNode::END:
+            return addNfaState(NFA_END, next);
+        case RegexNode::CONCAT:
+            for (size_t i = node.children.size(); i > 0 && next >= 0; i--) {
+                next = compile(*node.children[i - 1], next);
+            }
+            return next;
+        case RegexNode::ALTERNATE: {
+            int start = compile(*node.children.back(), next);
+            for (size_t i = node.children.size() - 1; i > 0 && start >= 0; i--) {
+                int branch = compile(*node.children[i - 1], next);
+                if (branch < 0) {
+                    return -1;
+                }
+                start = addNfaState(NFA_SPLIT, branch, start);
+            }
+            return start;
+        }
+        case RegexNode::REPEAT: {
+            const RegexNode& child = *node.children[0];
+            int start = next;
+            if (node.max < 0) {
+                int loop = addNfaState(NFA_SPLIT, -1, next);
+                int body = compile(child, loop);
+                if (body < 0) {
+                    return -1;
+                }
+                _nfa[loop].out = body;
+                start = loop;
+            } else {
+                for (int i = node.min; i < node.max && start >= 0; i++) {
+                    int body = compile(child, start);
+                    if (body < 0) {
+                        return -1;
+                    }
+                    start = addNfaState(NFA_SPLIT, body, next);
+                }
+            }
+            for (int i = 0; i < node.min && start >= 0; i++) {
+                start = compile(child, start);
+            }
+            return start;
+        }
+        }
+        return -1;
+    }
+
+    int RegexSearcher::addNfaState(NfaStateType type, int out, int out1, int byteSet) {
+        NfaState state;
+        state.type = type;
+        state.out = out;
+        state.out1 = out1;
+        state.byteSet = byteSet;
+        _nfa.push_back(state);
+        return (int)_nfa.size() - 1;
+    }
+
+    // Adds the states reachable from state without consuming input. Only byte, match and unresolved end states are kept.
+    // States already visited in the current generation are skipped
+    void RegexSearcher::addClosure(int state, bool atBegin, bool atEnd, std::vector<int>& states) {
+        _closureStack.clear();
+        _closureStack.push_back(state);
+        while (!_closureStack.empty()) {
+            int current = _closureStack.back();
+            _closureStack.pop_back();
+            if (_visited[current] == _generation) {
+                continue;
+            }
+            _visited[current] = _generation;
+
+            const NfaState& nfaState = _nfa[current];
+            switch (nfaState.type) {
+            case NFA_BYTES:
+            case NFA_MATCH:
+                states.push_back(current);
+                break;
+            case NFA_SPLIT:
+                _closureStack.push_back(nfaState.out1);
+                _closureStack.push_back(nfaState.out);
+                break;
+            case NFA_BEGIN:
+                if (atBegin) {
+                    _closureStack.push_back(nfaState.out);
+                }
+                break;
+            case NFA_END:
+                if (atEnd) {
+                    _closureStack.push_back(nfaState.out);
+                } else {
+                    states.push_back(current);
+                }
+                break;
+            }
+        }
+    }
+
+    void RegexSearcher::step(const std::vector<int>& from, unsigned char byte, std::vector<int>& to) {
+        to.clear();
+        _generation++;
+        for (int state : from) {
+            const NfaState& nfaState = _nfa[state];
+            if (nfaState.type == NFA_BYTES && _byteSets[nfaState.byteSet][byte]) {
+                addClosure(nfaState.out, false, false, to);
+            }
+        }
+        // the search is unanchored, a match can start at every position
+        addClosure(_startState, false, false, to);
+        std::sort(to.begin(), to.end());
+    }
+
+    bool RegexSearcher::containsMatch(const std::vector<int>& states) const {
+        for (int state : states) {
+            if (_nfa[state].type == NFA_MATCH) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    bool RegexSearcher::matchesAtEnd(const std::vector<int>& states, bool atBegin) {
+        std::vector<int> endStates;
+        _generation++;
+        for (int state : states) {
+            if (_nfa[state].type == NFA_END) {
+                addClosure(_nfa[state].out, atBegin, true, endStates);
+            }
+        }
+        return containsMatch(endStates);
+    }
+
+    int RegexSearcher::getDfaState(const std::vector<int>& nfaStates) {
+        auto it = _dfaIndex.find(nfaStates);
+        if (it != _dfaIndex.end()) {
+            return it->second;
+        }
+        if (_dfa.size() >= MAX_DFA_STATES) {
+            return -1;
+        }
+
+        _dfa.emplace_back();
+        initDfaState(_dfa.back(), nfaStates, false);
+        int index = (int)_dfa.size() - 1;
+        _dfaIndex.emplace(nfaStates, index);
+        return index;
+    }
+
+    void RegexSearcher::initDfaState(DfaState& state, const std::vector<int>& nfaStates, bool atBegin) {
+        state.nfaStates = nfaStates;
+        state.match = containsMatch(nfaStates);
+        state.matchAtEnd = matchesAtEnd(nfaStates, atBegin);
+        state.dead = nfaStates.empty();
+        std::fill(state.next, state.next + 256, -1);
+    }
+
+    void RegexSearcher::resetDfa() {
+        _dfa.resize(1);
+        std::fill(_dfa[0].next, _dfa[0].next + 256, -1);
+        _dfaIndex.clear();
+    }
+
+    bool RegexSearcher::searchNfa(const std::vector<int>& states, const unsigned char* data, unsigned int size) {
+        if (containsMatch(states)) {
+            return true;
+        }
+
+        std::vector<int> current = states;
+        std::vector<int> next;
+        for (unsigned int i = 0; i < size; i++) {
+            step(current, data[i], next);
+            if (containsMatch(next)) {
+                return true;
+            }
+            current.swap(next);
+        }
+        return matchesAtEnd(current, false);
+    }
+}
@@ -0,0 +1,108 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "LiteralSearcher.h"
+#include "MultiLiteralSearcher.h"
+
+#include <bitset>
+#include <map>
+#include <string>
+#include <vector>
+
+namespace PLP {
+    struct RegexNode;
+
+    // Regular expression search for the ECMAScript subset used in search patterns: literals, escapes, character classes,
+    // groups, alternation, greedy and lazy quantifiers and the ^ $ anchors. The pattern is compiled into a Thompson NFA
+    // which is run through a DFA built lazily while searching. If the DFA cache fills up, the rest of the line is simulated
+    // on the NFA directly and the cache is rebuilt on the next line.
+    // Literals that every match has to contain are extracted in initialize() and searched for first, so lines that cannot
+    // match never reach the automaton. Matching is byte based, the same as std::regex over std::string.
+    // initialize() returns false for patterns it doesn't support (backreferences, lookahead, word boundaries) so the
+    // caller can use std::regex instead
+    class RegexSearcher {
+    public:
+        bool initialize(const std::string& pattern, bool ignoreCase);
+        // Returns true if the pattern matches anywhere in data
+        bool search(const char* data, unsigned int size);
+        // Returns the literal every match contains if the prefilter is a single one, otherwise nullptr
+        const LiteralSearcher* getRequiredLiteral() const;
+
+    private:
+        enum NfaStateType {
+            NFA_BYTES,
+            NFA_SPLIT,
+            NFA_BEGIN,
+            NFA_END,
+            NFA_MATCH
+        };
+
+        struct NfaState {
+            NfaStateType type;
+            int out;
+            int out1;
+            int byteSet;
+        };
+
+        struct DfaState {
+            std::vector<int> nfaStates;
+            bool match;
+            bool matchAtEnd;
+            bool dead;
+            int next[256];
+        };
+
+        enum Prefilter {
+            PREFILTER_NONE,
+            PREFILTER_LITERAL,
+            PREFILTER_MULTI_LITERAL
+        };
+
+        static const unsigned int MAX_NFA_STATES = 10000;
+        static const unsigned int MAX_DFA_STATES = 2000;
+
+        int compile(const RegexNode& node, int next);
+        int addNfaState(NfaStateType type, int out, int out1 = -1, int byteSet = -1);
+        void addClosure(int state, bool atBegin, bool atEnd, std::vector<int>& states);
+        void step(const std::vector<int>& from, unsigned char byte, std::vector<int>& to);
+        bool containsMatch(const std::vector<int>& states) const;
+        bool matchesAtEnd(const std::vector<int>& states, bool atBegin);
+        int getDfaState(const std::vector<int>& nfaStates);
+        void initDfaState(DfaState& state, const std::vector<int>& nfaStates, bool atBegin);
+        void resetDfa();
+        bool searchNfa(const std::vector<int>& states, const unsigned char* data, unsigned int size);
+
+        std::vector<NfaState> _nfa;
+        std::vector<std::bitset<256>> _byteSets;
+        int _startState = -1;
+
+        std::vector<unsigned int> _visited;
+        unsigned int _generation = 0;
+        std::vector<int> _closureStack;
+        std::vector<int> _stepBuffer;
+
+        std::vector<DfaState> _dfa;
+        std::map<std::vector<int>, int> _dfaIndex;
+
+        Prefilter _prefilter = PREFILTER_NONE;
+        bool _literalOnly = false;
+        LiteralSearcher _literalSearcher;
+        MultiLiteralSearcher _multiLiteralSearcher;
+    };
+}
\ No newline at end of file
@@ -16,8 +16,10 @@
  */
 
 #include "Scanner.h"
+#include "LiteralSearcher.h"
 
 #include <cstdlib>
+#include <algorithm>
 
 namespace PLP {
     LineScanner::LineScanner(FileReaderI* fileReader, IndexReaderI* indexReader, unsigned long long startLine, unsigned long long endLine)
@@ -40,41 +42,25 @@ namespace PLP {
         }
 
         if (_indexReader) {
-            _nextLine = [&](unsigned long long& lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size) {
-                if (_firstLine) {
-                    do {
-                        if (!_indexReader->nextResult(lineNum)) {
-                            return LineReaderResult::NOT_FOUND;
-                        }
-                    } while (_indexReader->getLineNumber() < _startLine);
-
-                    if (_indexReader->getLineNumber() >= _endLine) {
-                        return LineReaderResult::NOT_FOUND;
-                    }
+            _indexExhausted = !_indexReader->seekToLine(_startLine);
 
-                    LineReaderResult res = _fileReader->getLineFromResult(_indexReader, data, size);
-                    if (res != LineReaderResult::SUCCESS) {
-                        return res;
-                    }
-
-                    fileOffset = _fileReader->getLineFileOffset();
-                    _firstLine = false;
-                } else {
-                    if (!_indexReader->nextResult(lineNum)) {
-                        return LineReaderResult::NOT_FOUND;
-                    }
+            // results are read ahead of the one being returned so that the file reader can load their lines
+            // while the current line is being processed
+            _nextLine = [&](unsigned long long& lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size) {
+                if (!fillPrefetchQueue()) {
+                    return LineReaderResult::NOT_FOUND;
+                }
 
-                    if (_indexReader->getLineNumber() >= _endLine) {
-                        return LineReaderResult::NOT_FOUND;
-                    }
+                lineNum = _prefetchQueue.front().first;
+                const unsigned long long resultFileOffset = _prefetchQueue.front().second;
+                _prefetchQueue.pop_front();
 
-                    LineReaderResult res = _fileReader->getLineFromResult(_indexReader, data, size);
-                    if (res != LineReaderResult::SUCCESS) {
-                        return res;
-                    }
-
-                    fileOffset = _fileReader->getLineFileOffset();
+                LineReaderResult res = _fileReader->getLineAtOffset(lineNum, resultFileOffset, data, size);
+                if (res != LineReaderResult::SUCCESS) {
+                    return res;
                 }
+
+                fileOffset = resultFileOffset;
                 return LineReaderResult::SUCCESS;
             };
         } else {
@@ -107,6 +93,28 @@ namespace PLP {
         return true;
     }
 
+    bool LineScanner::fillPrefetchQueue() {
+        IndexResult results[INDEX_PREFETCH_DEPTH];
+        while (!_indexExhausted && _prefetchQueue.size() < INDEX_PREFETCH_DEPTH) {
+            const unsigned long long numRead = _indexReader->nextResults(results, INDEX_PREFETCH_DEPTH - _prefetchQueue.size());
+            if (numRead == 0) {
+                _indexExhausted = true;
+                break;
+            }
+
+            for (unsigned long long i = 0; i < numRead; i++) {
+                if (results[i].lineNum > _endLine) {
+                    _indexExhausted = true;
+                    break;
+                }
+
+                _prefetchQueue.push_back({ results[i].lineNum, results[i].fileOffset });
+                _fileReader->prefetchLine(results[i].fileOffset);
+            }
+        }
+        return !_prefetchQueue.empty();
+    }
+
     LineReaderResult LineScanner::nextLine(unsigned long long& lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size) {
         return _nextLine(lineNum, fileOffset, data, size);
     }
@@ -124,6 +132,39 @@ namespace PLP {
         return { result, lineNum, std::string(lineStart, length) };
     }
 
+    LineReaderResult LineScanner::nextLineContaining(
+        const LiteralSearcher& literal,
+        unsigned long long maxLineNumber,
+        unsigned long long& lineNum,
+        unsigned long long& fileOffset,
+        char*& data,
+        unsigned int& size
+    ) {
+        if (_indexReader) {
+            return _nextLine(lineNum, fileOffset, data, size);
+        }
+
+        if (_firstLine) { // positions the reader on the start line
+            LineReaderResult res = _nextLine(lineNum, fileOffset, data, size);
+            if (res != LineReaderResult::SUCCESS || literal.find(data, size)) {
+                return res;
+            }
+        }
+
+        const unsigned long long lastLine = std::min(maxLineNumber, _endLine);
+        if (_fileReader->getLineNumber() >= lastLine) {
+            return LineReaderResult::NOT_FOUND;
+        }
+
+        LineReaderResult res = _fileReader->nextLineContaining(literal, lastLine, data, size);
+        if (res != LineReaderResult::SUCCESS) {
+            return res;
+        }
+        lineNum = _fileReader->getLineNumber();
+        fileOffset = _fileReader->getLineFileOffset();
+        return LineReaderResult::SUCCESS;
+    }
+
     MultilineScanner::MultilineScanner(
         FileReaderI* fileReader,
         IndexReaderI* indexReader,
@@ -174,11 +215,9 @@ namespace PLP {
             _nextFrame = [&]() {
                 if (_firstLine) {
                     unsigned long long refLineNum;
-                    do {
-                        if (!_indexReader->nextResult(refLineNum)) {
-                            return LineReaderResult::NOT_FOUND;
-                        }
-                    } while (refLineNum < _startLine);
+                    if (!_indexReader->seekToLine(_startLine) || !_indexReader->nextResult(refLineNum)) {
+                        return LineReaderResult::NOT_FOUND;
+                    }
 
                     if (refLineNum > _endLine) {
                         return LineReaderResult::NOT_FOUND;
@@ -189,6 +228,7 @@ namespace PLP {
                     if (res != LineReaderResult::SUCCESS) {
                         return res;
                     }
+                    _firstLine = false;
                 } else {
                     unsigned long long refLineNum;
                     if (!_indexReader->nextResult(refLineNum)) {
@@ -303,4 +343,58 @@ namespace PLP {
         }
         return { result, lineNum, std::string(data, size) };
     }
+    FrameReader::FrameReader(FileReaderI* fileReader, unsigned int numCachedLines)
+        : _fileReader(fileReader), _numCachedLines(numCachedLines) {
+    }
+
+    bool FrameReader::initialize() {
+        if (nullptr == _fileReader) {
+            return false;
+        }
+        return _lines.initialize(100000, _numCachedLines);
+    }
+
+    LineReaderResult FrameReader::getLine(unsigned long long lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size) {
+        if (lineNum >= _nextLine && lineNum - _nextLine < _numCachedLines && _numLines > 0) {
+            while (_nextLine <= lineNum) {
+                LineReaderResult res = readNext(_nextLine);
+                if (res != LineReaderResult::SUCCESS) {
+                    return res;
+                }
+            }
+        } else if (lineNum >= _nextLine || lineNum + _numLines < _nextLine) {
+            _numLines = 0;
+            LineReaderResult res = readNext(lineNum);
+            if (res != LineReaderResult::SUCCESS) {
+                return res;
+            }
+        }
+
+        unsigned long long lineNumber;
+        _lines.get(_numCachedLines - (unsigned int)(_nextLine - lineNum), lineNumber, fileOffset, data, size);
+        return LineReaderResult::SUCCESS;
+    }
+
+    LineReaderResult FrameReader::readNext(unsigned long long lineNum) {
+        char* data;
+        unsigned int size;
+        LineReaderResult res;
+        if (_numLines > 0 && lineNum == _nextLine) {
+            res = _fileReader->nextLine(data, size);
+        } else {
+            res = _fileReader->getLine(lineNum, data, size);
+        }
+        if (res != LineReaderResult::SUCCESS) {
+            _numLines = 0;
+            return res;
+        }
+
+        if (!_lines.pushBack(lineNum, _fileReader->getLineFileOffset(), data, size)) {
+            _numLines = 0;
+            return LineReaderResult::ERROR;
+        }
+        _numLines = std::min(_numLines + 1, _numCachedLines);
+        _nextLine = lineNum + 1;
+        return LineReaderResult::SUCCESS;
+    }
 }
\ No newline at end of file
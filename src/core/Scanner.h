@@ -22,6 +22,8 @@
 #include "FrameBuffer.h"
 
 #include <functional>
+#include <deque>
+#include <utility>
 
 namespace PLP {
     class LineScanner {
@@ -30,13 +32,29 @@ namespace PLP {
         bool initialize();
         LineReaderResult nextLine(unsigned long long& lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size);
         std::tuple<int, unsigned long long, std::string> nextLine();
+        // Returns the next line that contains literal, skipping the ones that don't without splitting them.
+        // NOT_FOUND means there is no such line up to maxLineNumber (or the end line), and the scan can be resumed with a larger one.
+        // When scanning an index every line is returned
+        LineReaderResult nextLineContaining(
+            const LiteralSearcher& literal,
+            unsigned long long maxLineNumber,
+            unsigned long long& lineNum,
+            unsigned long long& fileOffset,
+            char*& data,
+            unsigned int& size
+        );
     private:
+        static const unsigned int INDEX_PREFETCH_DEPTH = 32;
+        bool fillPrefetchQueue();
+
         FileReaderI* _fileReader = nullptr;
         IndexReaderI* _indexReader = nullptr;
         unsigned long long _startLine = 0;
         unsigned long long _endLine = 0;
 
         bool _firstLine = true;
+        bool _indexExhausted = false;
+        std::deque<std::pair<unsigned long long, unsigned long long>> _prefetchQueue; // line number, file offset
         std::function<LineReaderResult(unsigned long long& lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size)> _nextLine;
     };
 
@@ -68,4 +86,21 @@ namespace PLP {
         std::function<LineReaderResult()> _nextFrame;
         FrameBuffer _frameBuff;
     };
+    // Random access to the lines of multi-line frames. The most recent lines are kept, so frames that overlap are
+    // read once and the reader only moves forward while the frames do
+    class FrameReader {
+    public:
+        FrameReader(FileReaderI* fileReader, unsigned int numCachedLines);
+        bool initialize();
+        // Data stays valid until the next call
+        LineReaderResult getLine(unsigned long long lineNum, unsigned long long& fileOffset, char*& data, unsigned int& size);
+    private:
+        LineReaderResult readNext(unsigned long long lineNum);
+
+        FileReaderI* _fileReader = nullptr;
+        CircularLineBuffer _lines;
+        unsigned int _numCachedLines = 0;
+        unsigned int _numLines = 0;
+        unsigned long long _nextLine = 0; // line after the newest one in the buffer
+    };
 }
\ No newline at end of file
@@ -0,0 +1,221 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "SequenceMatcher.h"
+#include "TextComparator.h"
+
+namespace PLP {
+    SequenceMatcher::SequenceMatcher(
+        const std::vector<TextComparator*>& steps,
+        const std::vector<unsigned long long>& maxGaps,
+        const std::vector<int>& keyWords,
+        bool lastStepAbsent
+    ) : _steps(steps), _keyWords(keyWords), _lastStepAbsent(lastStepAbsent) {
+        _maxGaps.push_back(0);
+        _maxGaps.insert(_maxGaps.end(), maxGaps.begin(), maxGaps.end());
+    }
+
+    bool SequenceMatcher::initialize() {
+        if (_steps.empty() || _maxGaps.size() != _steps.size()) {
+            return false;
+        }
+        if (!_keyWords.empty() && _keyWords.size() != _steps.size()) {
+            return false;
+        }
+        if (_lastStepAbsent && (_steps.size() < 2 || _maxGaps.back() == 0)) { // absence is only known once the gap is over
+            return false;
+        }
+
+        try {
+            _plans.resize(_steps.size());
+            for (size_t i = 0; i < _steps.size(); i++) {
+                if (!_steps[i] || !_plans[i].compile(_steps[i])) {
+                    return false;
+                }
+            }
+            _waiting.resize(_steps.size());
+            _deadlines.resize(_steps.size());
+        } catch (std::bad_alloc&) {
+            return false;
+        }
+        _splitter.initializeWords();
+        return true;
+    }
+
+    bool SequenceMatcher::nextLine(
+        unsigned long long lineNum, 
+        unsigned long long fileOffset, 
+        const char* data, 
+        unsigned int size, 
+        const ResultHandler& onResult
+    ) {
+        expire(lineNum);
+
+        // later steps first, so that a sequence doesn't advance twice on the same line
+        const unsigned int lastStep = (unsigned int)_steps.size() - 1;
+        std::string key;
+        for (unsigned int step = lastStep; step > 0; step--) {
+            if (_waiting[step].empty() || !_plans[step].match(data, size) || !getKey(step, data, size, key)) {
+                continue;
+            }
+
+            auto it = _waiting[step].find(key);
+            if (it == _waiting[step].end()) {
+                continue;
+            }
+
+            std::deque<unsigned long long> ids;
+            ids.swap(it->second);
+            _waiting[step].erase(it);
+            _numWaiting -= ids.size();
+
+            for (unsigned long long id : ids) {
+                if (step < lastStep) {
+                    Sequence& sequence = _sequences[id];
+                    sequence.step = step + 1;
+                    sequence.lastLineNum = lineNum;
+                    _waiting[step + 1][key].push_back(id);
+                    if (_maxGaps[step + 1] > 0) {
+                        _deadlines[step + 1].push_back({ id, lineNum });
+                    }
+                    _numWaiting++;
+                } else if (_lastStepAbsent) {
+                    drop(id);
+                } else {
+                    complete(id);
+                }
+            }
+        }
+
+        if (_plans[0].match(data, size) && getKey(0, data, size, key)) {
+            if (lastStep == 0) {
+                _completed.insert({ lineNum, fileOffset });
+            } else {
+                const unsigned long long id = _nextId++;
+                _sequences[id] = { lineNum, fileOffset, lineNum, 1, key };
+                _waiting[1][key].push_back(id);
+                if (_maxGaps[1] > 0) {
+                    _deadlines[1].push_back({ id, lineNum });
+                }
+                _pendingHeads.insert(lineNum);
+                _numWaiting++;
+            }
+        }
+
+        return flush(false, onResult);
+    }
+
+    bool SequenceMatcher::finish(const ResultHandler& onResult) {
+        const unsigned int lastStep = (unsigned int)_steps.size() - 1;
+        for (auto& it : _sequences) {
+            if (_lastStepAbsent && it.second.step == lastStep) {
+                _completed.insert({ it.second.headLineNum, it.second.headFileOffset });
+            }
+        }
+
+        _sequences.clear();
+        for (size_t i = 0; i < _steps.size(); i++) {
+            _waiting[i].clear();
+            _deadlines[i].clear();
+        }
+        _pendingHeads.clear();
+        _numWaiting = 0;
+        return flush(true, onResult);
+    }
+
+    bool SequenceMatcher::isWaiting() const {
+        return _numWaiting > 0;
+    }
+
+    bool SequenceMatcher::getKey(unsigned int step, const char* data, unsigned int size, std::string& key) {
+        if (_keyWords.empty()) {
+            key.clear();
+            return true;
+        }
+
+        const int index = _keyWords[step];
+        const unsigned int numFirst = index >= 0 ? (unsigned int)index + 1 : 0;
+        const unsigned int numLast = index < 0 ? (unsigned int)-index + 1 : 0;
+        if (!_splitter.split(data, size, numFirst, numLast)) {
+            return false;
+        }
+
+        const FieldSplitter::Field& word = _splitter.getField(index);
+        key.assign(word.first, word.second);
+        return true;
+    }
+
+    void SequenceMatcher::expire(unsigned long long lineNum) {
+        const unsigned int lastStep = (unsigned int)_steps.size() - 1;
+        for (unsigned int step = 1; step <= lastStep; step++) {
+            std::deque<std::pair<unsigned long long, unsigned long long>>& deadlines = _deadlines[step];
+            while (!deadlines.empty() && deadlines.front().second + _maxGaps[step] < lineNum) {
+                const unsigned long long id = deadlines.front().first;
+                const unsigned long long stepLineNum = deadlines.front().second;
+                deadlines.pop_front();
+
+                auto it = _sequences.find(id);
+                if (it == _sequences.end() || it->second.step != step || it->second.lastLineNum != stepLineNum) {
+                    continue;
+                }
+
+                // deadlines and the waiting sequences of a key are both in line order, so this sequence is the oldest of its key
+                auto waiting = _waiting[step].find(it->second.key);
+                waiting->second.pop_front();
+                if (waiting->second.empty()) {
+                    _waiting[step].erase(waiting);
+                }
+                _numWaiting--;
+
+                if (_lastStepAbsent && step == lastStep) {
+                    complete(id);
+                } else {
+                    drop(id);
+                }
+            }
+        }
+    }
+
+    void SequenceMatcher::complete(unsigned long long id) {
+        auto it = _sequences.find(id);
+        _completed.insert({ it->second.headLineNum, it->second.headFileOffset });
+        _pendingHeads.erase(it->second.headLineNum);
+        _sequences.erase(it);
+    }
+
+    void SequenceMatcher::drop(unsigned long long id) {
+        auto it = _sequences.find(id);
+        _pendingHeads.erase(it->second.headLineNum);
+        _sequences.erase(it);
+    }
+
+    // results are held back until every sequence that started before them is decided
+    bool SequenceMatcher::flush(bool all, const ResultHandler& onResult) {
+        while (!_completed.empty()) {
+            const std::pair<unsigned long long, unsigned long long> result = *_completed.begin();
+            if (!all && !_pendingHeads.empty() && *_pendingHeads.begin() < result.first) {
+                break;
+            }
+
+            _completed.erase(_completed.begin());
+            if (!onResult(result.first, result.second)) {
+                return false;
+            }
+        }
+        return true;
+    }
+}
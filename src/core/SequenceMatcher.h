@@ -0,0 +1,95 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "ComparatorPlan.h"
+#include "FieldSplitter.h"
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <set>
+#include <unordered_map>
+#include <functional>
+#include <utility>
+
+namespace PLP {
+    class TextComparator;
+
+    // Streaming search for sequences of lines that match a list of steps in order. Every line that matches the first step
+    // starts a sequence, which advances to the next step on the first following line that matches it. A step can be
+    // limited to a number of lines after the previous step (maxGaps, 0 for no limit), and the lines of a sequence can be
+    // linked by a key: the word at keyWords[step] of each line (see MatchWords). If lastStepAbsent is set, a sequence
+    // matches when its last step does NOT appear within its gap.
+    // Results are the first lines of the matched sequences, reported in line order
+    class SequenceMatcher {
+    public:
+        typedef std::function<bool(unsigned long long lineNum, unsigned long long fileOffset)> ResultHandler;
+
+        // Comparators have to be initialized and outlive the matcher. maxGaps has one entry per step after the first,
+        // keyWords one entry per step or none
+        SequenceMatcher(
+            const std::vector<TextComparator*>& steps,
+            const std::vector<unsigned long long>& maxGaps,
+            const std::vector<int>& keyWords,
+            bool lastStepAbsent
+        );
+        bool initialize();
+
+        // Lines have to be passed in order but may skip ahead while isWaiting() is false.
+        // Returns false if onResult did
+        bool nextLine(unsigned long long lineNum, unsigned long long fileOffset, const char* data, unsigned int size, const ResultHandler& onResult);
+        // Ends the search. Sequences that are still waiting for an absent last step match
+        bool finish(const ResultHandler& onResult);
+        // True if a sequence is waiting for a step other than the first
+        bool isWaiting() const;
+
+    private:
+        struct Sequence {
+            unsigned long long headLineNum;
+            unsigned long long headFileOffset;
+            unsigned long long lastLineNum;
+            unsigned int step; // next step to match
+            std::string key;
+        };
+
+        bool getKey(unsigned int step, const char* data, unsigned int size, std::string& key);
+        void expire(unsigned long long lineNum);
+        void complete(unsigned long long id);
+        void drop(unsigned long long id);
+        bool flush(bool all, const ResultHandler& onResult);
+
+        std::vector<TextComparator*> _steps;
+        std::vector<unsigned long long> _maxGaps; // per step, 0 for the first
+        std::vector<int> _keyWords;
+        bool _lastStepAbsent;
+
+        std::vector<ComparatorPlan> _plans;
+        FieldSplitter _splitter;
+        std::unordered_map<unsigned long long, Sequence> _sequences;
+        unsigned long long _nextId = 0;
+        // sequences waiting for each step by key, oldest first
+        std::vector<std::unordered_map<std::string, std::deque<unsigned long long>>> _waiting;
+        // sequence and line of the previous step for each step with a gap, in line order. Entries of sequences that
+        // moved on are skipped when they come up
+        std::vector<std::deque<std::pair<unsigned long long, unsigned long long>>> _deadlines;
+        std::set<unsigned long long> _pendingHeads;
+        std::set<std::pair<unsigned long long, unsigned long long>> _completed; // head line number, file offset
+        unsigned long long _numWaiting = 0;
+    };
+}
@@ -18,6 +18,7 @@
 #pragma once
 
 #include <functional>
+#include <thread>
 #include "tbb/atomic.h"
 
 namespace PLP {
@@ -43,6 +44,12 @@ namespace PLP {
     class TaskRunner {
     public:
         virtual void runAsync(std::function<void()> task, TaskStatus& status) = 0;
+        // Blocks until the task of the given status is completed
+        virtual void wait(TaskStatus& status) {
+            while (!status.isCompleted()) {
+                std::this_thread::yield();
+            }
+        }
         virtual ~TaskRunner() {}
     };
 }
\ No newline at end of file
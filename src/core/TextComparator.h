@@ -18,8 +18,15 @@
 #pragma once
 
 #include "Utils.h"
+#include "LiteralSearcher.h"
+#include "MultiLiteralSearcher.h"
+#include "RegexSearcher.h"
+#include "ByteSearch.h"
+#include "CaseFolding.h"
+#include "FieldSplitter.h"
 
 #include <string>
+#include <cstring>
 #include <regex>
 #include <vector>
 #include <unordered_map>
@@ -27,80 +34,514 @@
 #include <memory>
 #include <cwctype>
 #include <functional>
+#include <chrono>
 
 namespace PLP {
+    class ComparatorPlan;
+
+    // A line handed to TextComparator::matchBatch
+    struct LineSpan {
+        const char* data;
+        unsigned int size;
+    };
+
     class TextComparator {
     public:
+        virtual ~TextComparator() {}
         virtual bool initialize() = 0;
         virtual bool match(const char* data, unsigned int size) = 0;
         virtual bool match(const std::string& str) = 0;
+        // Matches the lines whose selection entry is non-zero. On return the entry is 1 for the lines that matched and 0
+        // for the rest. Lines that were not selected are not evaluated
+        virtual void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) {
+            for (unsigned int i = 0; i < count; i++) {
+                if (selection[i]) {
+                    selection[i] = match(lines[i].data, lines[i].size) ? 1 : 0;
+                }
+            }
+        }
+        // Returns an uninitialized copy that can be used on another thread, or nullptr if the comparator cannot be copied
+        virtual std::shared_ptr<TextComparator> clone() const = 0;
+        // Returns false if clone() would return nullptr, without copying anything
+        virtual bool isCloneable() const {
+            return true;
+        }
+        // Returns a literal that every matching line contains, or nullptr if there is none. Scanners use it to find
+        // candidate lines by searching whole pages; match() is still called on every candidate
+        virtual const LiteralSearcher* getRequiredLiteral() const {
+            return nullptr;
+        }
+        // Rough time in nanoseconds that match() takes on an average line, used to order the children of MatchAll and MatchAny
+        virtual double getCost() const = 0;
+        // Adds the runtime statistics collected by a clone of this comparator, see ComparatorSequence
+        virtual void addStatsFrom(const TextComparator& clone) {}
+        // Writes the statistics of this comparator and its children, one line per child, indented by depth
+        virtual void appendStats(std::string& out, unsigned int depth) const {}
+
+        std::string getStats() const {
+            std::string stats;
+            appendStats(stats, 0);
+            return stats;
+        }
+
+    protected:
+        static bool allCloneable(const std::vector<std::pair<int, std::shared_ptr<TextComparator>>>& comparators) {
+            for (auto& comparator : comparators) {
+                if (!comparator.second->isCloneable()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool cloneAll(
+            const std::vector<std::pair<int, std::shared_ptr<TextComparator>>>& comparators,
+            std::unordered_map<int, std::shared_ptr<TextComparator>>& clones
+        ) {
+            for (auto& comparator : comparators) {
+                std::shared_ptr<TextComparator> clone = comparator.second->clone();
+                if (!clone) {
+                    return false;
+                }
+                clones.emplace(comparator.first, clone);
+            }
+            return true;
+        }
+
+        // Number of fields a FieldSplitter has to find from the start and from the end of a line for the indexes to be
+        // in bounds. Index i needs more than i fields and index -i more than i fields
+        static void getSplitBounds(
+            const std::vector<std::pair<int, std::shared_ptr<TextComparator>>>& comparators,
+            unsigned int& numFirst,
+            unsigned int& numLast
+        ) {
+            numFirst = 0;
+            numLast = 0;
+            for (auto& comparator : comparators) {
+                if (comparator.first >= 0) {
+                    numFirst = std::max(numFirst, (unsigned int)comparator.first + 1);
+                } else {
+                    numLast = std::max(numLast, (unsigned int)-comparator.first + 1);
+                }
+            }
+        }
     };
 
-    class MatchAll : public TextComparator {
+    // The children of MatchAll and MatchAny. Evaluation stops at the first child that returns stopResult, so the children
+    // are ordered to reach that result as cheaply as possible: by cost / probability of returning stopResult.
+    // The order starts from the static cost estimates and is re-ranked periodically from the hit counts of each child
+    // and from timing a sample of the evaluations. Children are expected to be free of side effects; a sequence with a
+    // child that can't be cloned (MatchCustom) may call into Lua and keeps its declared order
+    class ComparatorSequence {
     public:
-        MatchAll(const std::vector<std::shared_ptr<TextComparator>>& comparators) {
-            _comparators = comparators;
-        }
+        ComparatorSequence(const std::vector<std::shared_ptr<TextComparator>>& comparators, bool stopResult)
+            : _comparators(comparators), _stopResult(stopResult) {}
 
-        bool initialize() override {
+        bool initialize() {
             for (auto& comparator : _comparators) {
                 if (!comparator->initialize()) {
                     return false;
                 }
             }
+
+            try {
+                _stats.assign(_comparators.size(), ChildStats());
+                _order.clear();
+                for (unsigned int i = 0; i < _comparators.size(); i++) {
+                    _order.push_back(i);
+                }
+            } catch (std::bad_alloc&) {
+                return false;
+            }
+            _numEvaluations = 0;
+            _fixedOrder = !isCloneable();
+            rerank();
             return true;
         }
 
-        bool match(const char* data, unsigned int size) override {
+        // Returns stopResult if any child returned it, otherwise the opposite
+        bool evaluate(const char* data, unsigned int size) {
+            _numEvaluations++;
+            const bool timed = _numEvaluations % TIMING_SAMPLE_INTERVAL == 0;
+            bool stopped = false;
+            for (unsigned int index : _order) {
+                ChildStats& stats = _stats[index];
+                bool result;
+                if (timed) {
+                    auto start = std::chrono::steady_clock::now();
+                    result = _comparators[index]->match(data, size);
+                    stats.timeNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                    stats.numTimed++;
+                } else {
+                    result = _comparators[index]->match(data, size);
+                }
+
+                stats.numEvaluations++;
+                if (result) {
+                    stats.numMatches++;
+                }
+                if (result == _stopResult) {
+                    stopped = true;
+                    break;
+                }
+            }
+
+            if (_numEvaluations % RERANK_INTERVAL == 0) {
+                rerank();
+            }
+            return stopped ? _stopResult : !_stopResult;
+        }
+
+        // Batch version of evaluate(). Every child runs over the lines that are still undecided, and the children are
+        // re-ranked after each batch. The batch calls are always timed since the cost of timing is spread over the lines
+        void evaluateBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) {
+            unsigned long long numUndecided = countSelected(selection, count);
+            _numEvaluations += numUndecided;
+
+            unsigned char* undecided = selection;
+            if (_stopResult) {
+                _undecided.assign(selection, selection + count);
+                std::fill(selection, selection + count, 0);
+                undecided = _undecided.data();
+            }
+
+            for (unsigned int index : _order) {
+                if (numUndecided == 0) {
+                    break;
+                }
+
+                unsigned char* childSelection = undecided;
+                if (_stopResult) {
+                    _childSelection.assign(undecided, undecided + count);
+                    childSelection = _childSelection.data();
+                }
+
+                auto start = std::chrono::steady_clock::now();
+                _comparators[index]->matchBatch(lines, count, childSelection);
+                ChildStats& stats = _stats[index];
+                stats.timeNs += (double)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+                stats.numTimed += numUndecided;
+
+                const unsigned long long numMatches = countSelected(childSelection, count);
+                stats.numEvaluations += numUndecided;
+                stats.numMatches += numMatches;
+
+                if (_stopResult) { // matched lines are decided, the rest go to the next child
+                    for (unsigned int i = 0; i < count; i++) {
+                        if (childSelection[i]) {
+                            selection[i] = 1;
+                            undecided[i] = 0;
+                        }
+                    }
+                    numUndecided -= numMatches;
+                } else {
+                    numUndecided = numMatches;
+                }
+            }
+
+            rerank();
+        }
+
+        double getCost() const {
+            double cost = 0;
             for (auto& comparator : _comparators) {
-                if (!comparator->match(data, size)) {
+                cost += comparator->getCost();
+            }
+            return cost;
+        }
+
+        bool clone(std::vector<std::shared_ptr<TextComparator>>& clones) const {
+            for (auto& comparator : _comparators) {
+                std::shared_ptr<TextComparator> clone = comparator->clone();
+                if (!clone) {
                     return false;
                 }
+                clones.push_back(clone);
             }
             return true;
         }
 
-        bool match(const std::string& str) {
-            return match(str.c_str(), (unsigned int)str.length());
+        bool isCloneable() const {
+            for (auto& comparator : _comparators) {
+                if (!comparator->isCloneable()) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        const std::vector<std::shared_ptr<TextComparator>>& getComparators() const {
+            return _comparators;
+        }
+
+        bool getStopResult() const {
+            return _stopResult;
+        }
+
+        // evaluation order as indices into getComparators()
+        const std::vector<unsigned int>& getOrder() const {
+            return _order;
+        }
+
+        // used by ComparatorPlan, which evaluates the children itself
+        void recordEvaluation() {
+            _numEvaluations++;
+        }
+
+        void recordResult(unsigned int index, bool result) {
+            _stats[index].numEvaluations++;
+            if (result) {
+                _stats[index].numMatches++;
+            }
+        }
+
+        void rerank() {
+            if (_fixedOrder) {
+                return;
+            }
+
+            std::vector<double> keys(_comparators.size());
+            for (size_t i = 0; i < keys.size(); i++) {
+                keys[i] = getRankKey(i);
+            }
+            std::stable_sort(_order.begin(), _order.end(), [&keys](unsigned int first, unsigned int second) {
+                return keys[first] < keys[second];
+            });
+        }
+
+        void addStatsFrom(const ComparatorSequence& clone) {
+            if (clone._stats.size() != _stats.size()) {
+                return;
+            }
+            _numEvaluations += clone._numEvaluations;
+            for (size_t i = 0; i < _stats.size(); i++) {
+                _stats[i].numEvaluations += clone._stats[i].numEvaluations;
+                _stats[i].numMatches += clone._stats[i].numMatches;
+                _stats[i].numTimed += clone._stats[i].numTimed;
+                _stats[i].timeNs += clone._stats[i].timeNs;
+                _comparators[i]->addStatsFrom(*clone._comparators[i]);
+            }
+        }
+
+        void appendStats(const char* name, std::string& out, unsigned int depth) const {
+            out += std::string(depth * 2, ' ') + name + ": " + std::to_string(_numEvaluations) + " evaluated\n";
+            for (size_t i = 0; i < _comparators.size(); i++) {
+                const ChildStats& stats = _stats[i];
+                out += std::string(depth * 2 + 2, ' ') + "#" + std::to_string(i + 1)
+                    + " rank " + std::to_string(getRank((unsigned int)i) + 1)
+                    + ": evaluated " + std::to_string(stats.numEvaluations)
+                    + ", matched " + std::to_string(stats.numMatches)
+                    + ", ~" + std::to_string((unsigned long long)getChildCost(i)) + " ns\n";
+                _comparators[i]->appendStats(out, depth + 2);
+            }
         }
 
     private:
+        struct ChildStats {
+            unsigned long long numEvaluations = 0;
+            unsigned long long numMatches = 0;
+            unsigned long long numTimed = 0;
+            double timeNs = 0;
+        };
+
+        static const unsigned long long TIMING_SAMPLE_INTERVAL = 64;
+        static const unsigned long long RERANK_INTERVAL = 4096;
+        static const unsigned long long MIN_TIMED_SAMPLES = 8;
+
+        double getChildCost(size_t index) const {
+            const ChildStats& stats = _stats[index];
+            if (stats.numTimed >= MIN_TIMED_SAMPLES) {
+                return stats.timeNs / stats.numTimed;
+            }
+            return _comparators[index]->getCost();
+        }
+
+        // expected cost of evaluating the child per line that it settles
+        double getRankKey(size_t index) const {
+            const ChildStats& stats = _stats[index];
+            const double matchProbability = (stats.numMatches + 1.0) / (stats.numEvaluations + 2.0);
+            const double stopProbability = _stopResult ? matchProbability : 1.0 - matchProbability;
+            return getChildCost(index) / stopProbability;
+        }
+
+        unsigned int getRank(unsigned int index) const {
+            return (unsigned int)(std::find(_order.begin(), _order.end(), index) - _order.begin());
+        }
+
+        static unsigned long long countSelected(const unsigned char* selection, unsigned int count) {
+            unsigned long long numSelected = 0;
+            for (unsigned int i = 0; i < count; i++) {
+                numSelected += selection[i] ? 1 : 0;
+            }
+            return numSelected;
+        }
+
         std::vector<std::shared_ptr<TextComparator>> _comparators;
+        std::vector<unsigned int> _order;
+        std::vector<ChildStats> _stats;
+        std::vector<unsigned char> _undecided;
+        std::vector<unsigned char> _childSelection;
+        unsigned long long _numEvaluations = 0;
+        bool _stopResult;
+        bool _fixedOrder = false;
     };
 
-    class MatchAny : public TextComparator {
+    class MatchAll : public TextComparator {
+        friend class ComparatorPlan;
     public:
-        MatchAny(const std::vector<std::shared_ptr<TextComparator>>& comparators) {
-            _comparators = comparators;
-        }
+        MatchAll(const std::vector<std::shared_ptr<TextComparator>>& comparators) : _sequence(comparators, false) {}
 
         bool initialize() override {
-            for (auto& comparator : _comparators) {
-                if (!comparator->initialize()) {
-                    return false;
+            return _sequence.initialize();
+        }
+
+        bool match(const char* data, unsigned int size) override {
+            return _sequence.evaluate(data, size);
+        }
+
+        bool match(const std::string& str) {
+            return match(str.c_str(), (unsigned int)str.length());
+        }
+
+        void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) override {
+            _sequence.evaluateBatch(lines, count, selection);
+        }
+
+        std::shared_ptr<TextComparator> clone() const override {
+            std::vector<std::shared_ptr<TextComparator>> clones;
+            if (!_sequence.clone(clones)) {
+                return nullptr;
+            }
+            return std::make_shared<MatchAll>(clones);
+        }
+
+        bool isCloneable() const override {
+            return _sequence.isCloneable();
+        }
+
+        double getCost() const override {
+            return _sequence.getCost();
+        }
+
+        void addStatsFrom(const TextComparator& clone) override {
+            const MatchAll* other = dynamic_cast<const MatchAll*>(&clone);
+            if (other) {
+                _sequence.addStatsFrom(other->_sequence);
+            }
+        }
+
+        void appendStats(std::string& out, unsigned int depth) const override {
+            _sequence.appendStats("MatchAll", out, depth);
+        }
+
+        const LiteralSearcher* getRequiredLiteral() const override {
+            const LiteralSearcher* longest = nullptr;
+            for (auto& comparator : _sequence.getComparators()) {
+                const LiteralSearcher* literal = comparator->getRequiredLiteral();
+                if (literal && (!longest || literal->getNeedleSize() > longest->getNeedleSize())) {
+                    longest = literal;
                 }
             }
-            return true;
+            return longest;
+        }
+
+    private:
+        ComparatorSequence _sequence;
+    };
+
+    class MatchAny : public TextComparator {
+        friend class ComparatorPlan;
+    public:
+        MatchAny(const std::vector<std::shared_ptr<TextComparator>>& comparators) : _sequence(comparators, true) {}
+
+        bool initialize() override {
+            return _sequence.initialize();
         }
 
         bool match(const char* data, unsigned int size) override {
-            for (auto& comparator : _comparators) {
-                if (comparator->match(data, size)) {
-                    return true;
-                }
+            return _sequence.evaluate(data, size);
+        }
+
+        bool match(const std::string& str) {
+            return match(str.c_str(), (unsigned int)str.length());
+        }
+
+        void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) override {
+            _sequence.evaluateBatch(lines, count, selection);
+        }
+
+        std::shared_ptr<TextComparator> clone() const override {
+            std::vector<std::shared_ptr<TextComparator>> clones;
+            if (!_sequence.clone(clones)) {
+                return nullptr;
             }
-            return false;
+            return std::make_shared<MatchAny>(clones);
+        }
+
+        bool isCloneable() const override {
+            return _sequence.isCloneable();
+        }
+
+        double getCost() const override {
+            return _sequence.getCost();
+        }
+
+        void addStatsFrom(const TextComparator& clone) override {
+            const MatchAny* other = dynamic_cast<const MatchAny*>(&clone);
+            if (other) {
+                _sequence.addStatsFrom(other->_sequence);
+            }
+        }
+
+        void appendStats(std::string& out, unsigned int depth) const override {
+            _sequence.appendStats("MatchAny", out, depth);
+        }
+
+    private:
+        ComparatorSequence _sequence;
+    };
+
+    // Equivalent to MatchAny over MatchString comparators, but checks all strings in one pass over the line
+    class MatchAnyString : public TextComparator {
+        friend class ComparatorPlan;
+    public:
+        MatchAnyString(const std::vector<std::string>& texts) : _texts(texts) {}
+
+        bool initialize() override {
+            return _searcher.initialize(_texts);
+        }
+
+        bool match(const char* data, unsigned int size) override {
+            return _searcher.containsAny(data, size);
         }
 
         bool match(const std::string& str) {
             return match(str.c_str(), (unsigned int)str.length());
         }
 
+        void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) override {
+            for (unsigned int i = 0; i < count; i++) {
+                if (selection[i]) {
+                    selection[i] = _searcher.containsAny(lines[i].data, lines[i].size) ? 1 : 0;
+                }
+            }
+        }
+
+        std::shared_ptr<TextComparator> clone() const override {
+            return std::make_shared<MatchAnyString>(_texts);
+        }
+
+        double getCost() const override {
+            return 40;
+        }
+
     private:
-        std::vector<std::shared_ptr<TextComparator>> _comparators;
+        MultiLiteralSearcher _searcher;
+        std::vector<std::string> _texts;
     };
 
     class MatchNot : public TextComparator {
+        friend class ComparatorPlan;
     public:
         MatchNot(std::shared_ptr<TextComparator> comparator) : _comparator(comparator) {}
 
@@ -116,70 +557,212 @@ namespace PLP {
             return match(str.c_str(), (unsigned int)str.length());
         }
 
+        void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) override {
+            _childSelection.assign(selection, selection + count);
+            _comparator->matchBatch(lines, count, _childSelection.data());
+            for (unsigned int i = 0; i < count; i++) {
+                selection[i] = (selection[i] && !_childSelection[i]) ? 1 : 0;
+            }
+        }
+
+        std::shared_ptr<TextComparator> clone() const override {
+            std::shared_ptr<TextComparator> comparator = _comparator->clone();
+            if (!comparator) {
+                return nullptr;
+            }
+            return std::make_shared<MatchNot>(comparator);
+        }
+
+        bool isCloneable() const override {
+            return _comparator->isCloneable();
+        }
+
+        double getCost() const override {
+            return _comparator->getCost();
+        }
+
+        void addStatsFrom(const TextComparator& clone) override {
+            const MatchNot* other = dynamic_cast<const MatchNot*>(&clone);
+            if (other) {
+                _comparator->addStatsFrom(*other->_comparator);
+            }
+        }
+
+        void appendStats(std::string& out, unsigned int depth) const override {
+            _comparator->appendStats(out, depth);
+        }
+
     private:
         std::shared_ptr<TextComparator> _comparator;
+        std::vector<unsigned char> _childSelection;
     };
 
     class MatchString : public TextComparator {
+        friend class ComparatorPlan;
     public:
-        MatchString(const std::string& text, bool exact) {
-            std::wstring wText = string_to_wstring(text);
-            if (exact) {
-                _match = [text](const char* data, unsigned int size) {
-                    return std::string(data, size).compare(text) == 0;
-                };
-            } else {
-                _match = [text](const char* data, unsigned int size) {
-                    return std::string::npos != std::string(data, size).find(text);
-                };
-            }
-        }
+        MatchString(const std::string& text, bool exact, bool ignoreCase = false)
+            : _text(text), _exact(exact), _ignoreCase(ignoreCase) {}
 
         bool initialize() override {
-            return true;
+            if (!_ignoreCase) {
+                return _searcher.initialize(_text);
+            }
+
+            // ASCII lines fold by ASCII rules alone, so they are matched against the folded needle without copying.
+            // Lines with non-ASCII bytes can fold into ASCII (U+0130 to "i") and are always folded as UTF-8 first
+            try {
+                foldCaseUtf8(_text.data(), (unsigned int)_text.size(), _foldedText);
+            } catch (std::bad_alloc&) {
+                return false;
+            }
+            _asciiText = isAscii(_foldedText.data(), _foldedText.data() + _foldedText.size());
+            return _searcher.initialize(_foldedText, _asciiText);
         }
 
         bool match(const char* data, unsigned int size) override {
-            return _match(data, size);
+            if (!_ignoreCase) {
+                if (_exact) {
+                    return size == _text.size() && memcmp(data, _text.data(), size) == 0;
+                }
+                return _searcher.find(data, size) != nullptr;
+            }
+
+            if (isAscii(data, data + size)) {
+                if (!_asciiText) { // an ASCII line can't contain the folded non-ASCII needle
+                    return false;
+                }
+                if (_exact) {
+                    return size == _foldedText.size() && equalsIgnoreCaseAscii(data, _foldedText.data(), size);
+                }
+                return _searcher.find(data, size) != nullptr;
+            }
+
+            try {
+                foldCaseUtf8(data, size, _foldBuffer);
+            } catch (std::bad_alloc&) {
+                return false;
+            }
+            if (_exact) {
+                return _foldBuffer == _foldedText;
+            }
+            return _searcher.find(_foldBuffer.data(), (unsigned int)_foldBuffer.size()) != nullptr;
         }
 
         bool match(const std::string& str) {
             return match(str.c_str(), (unsigned int)str.length());
         }
 
+        void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) override {
+            if (!_ignoreCase && !_exact) {
+                for (unsigned int i = 0; i < count; i++) {
+                    if (selection[i]) {
+                        selection[i] = _searcher.find(lines[i].data, lines[i].size) != nullptr ? 1 : 0;
+                    }
+                }
+                return;
+            }
+            for (unsigned int i = 0; i < count; i++) {
+                if (selection[i]) {
+                    selection[i] = MatchString::match(lines[i].data, lines[i].size) ? 1 : 0;
+                }
+            }
+        }
+
+        std::shared_ptr<TextComparator> clone() const override {
+            return std::make_shared<MatchString>(_text, _exact, _ignoreCase);
+        }
+
+        const LiteralSearcher* getRequiredLiteral() const override {
+            // a case-insensitive needle can be matched by non-ASCII bytes the literal search can't see
+            if (_text.empty() || _ignoreCase) {
+                return nullptr;
+            }
+            return &_searcher;
+        }
+
+        double getCost() const override {
+            return (_ignoreCase && !_asciiText) ? 80 : 20;
+        }
+
     private:
-        std::function<bool(const char* data, unsigned int size)> _match;
+        LiteralSearcher _searcher;
+        std::string _text;
+        std::string _foldedText;
+        std::string _foldBuffer;
+        bool _exact;
+        bool _ignoreCase;
+        bool _asciiText = true;
     };
 
     class MatchRegex : public TextComparator {
+        friend class ComparatorPlan;
     public:
-        MatchRegex(const std::string& regexPattern) : _regexPattern(regexPattern) {}
+        MatchRegex(const std::string& regexPattern, bool ignoreCase = false) : _regexPattern(regexPattern), _ignoreCase(ignoreCase) {}
 
         bool initialize() override {
             std::regex_constants::syntax_option_type flags = std::regex_constants::optimize;
+            if (_ignoreCase) {
+                flags |= std::regex_constants::icase;
+            }
             try {
+                // std::regex still decides which patterns are valid, and runs the ones RegexSearcher doesn't support
                 std::regex regex(_regexPattern, flags);
-                _match = [regex](const std::string& data) {
-                    return std::regex_search(data, regex);
-                };
+                _useSearcher = _searcher.initialize(_regexPattern, _ignoreCase);
+                if (!_useSearcher) {
+                    _match = [regex](const std::string& data) {
+                        return std::regex_search(data, regex);
+                    };
+                }
             } catch (std::regex_error&) {
                 return false;
+            } catch (std::bad_alloc&) {
+                return false;
             }
 
             return true;
         }
 
         bool match(const char* data, unsigned int size) override {
+            if (_useSearcher) {
+                return _searcher.search(data, size);
+            }
             return _match(std::string(data, size));
         }
 
         bool match(const std::string& str) {
-            return _match(str);
+            return match(str.c_str(), (unsigned int)str.length());
+        }
+
+        void matchBatch(const LineSpan* lines, unsigned int count, unsigned char* selection) override {
+            if (!_useSearcher) {
+                TextComparator::matchBatch(lines, count, selection);
+                return;
+            }
+            for (unsigned int i = 0; i < count; i++) {
+                if (selection[i]) {
+                    selection[i] = _searcher.search(lines[i].data, lines[i].size) ? 1 : 0;
+                }
+            }
+        }
+
+        std::shared_ptr<TextComparator> clone() const override {
+            return std::make_shared<MatchRegex>(_regexPattern, _ignoreCase);
+        }
+
+        const LiteralSearcher* getRequiredLiteral() const override {
+            return _useSearcher ? _searcher.getRequiredLiteral() : nullptr;
+        }
+
+        double getCost() const override {
+            return _useSearcher ? 100 : 2000;
         }
 
     private:
+        RegexSearcher _searcher;
+        bool _useSearcher = false;
         std::function<bool(const std::string& data)> _match;
         std::string _regexPattern;
+        bool _ignoreCase;
     };
 
     class MatchSubstrings : public TextComparator {
@@ -195,15 +778,14 @@ namespace PLP {
                     [](const std::pair<int, std::shared_ptr<TextComparator>>& comp1, const std::pair<int, std::shared_ptr<TextComparator>>& comp2) {
                     return comp1.first < comp2.first;
                 });
-
-                _substrings.reserve(100);
             } catch (std::bad_alloc&) {
                 _internalFailure = true;
             }
+            getSplitBounds(_sliceComparators, _numFirstSlices, _numLastSlices);
         }
 
         bool initialize() override {
-            if (_internalFailure) {
+            if (_internalFailure || !_splitter.initializeDelimiter(_splitText)) {
                 return false;
             }
 
@@ -216,46 +798,25 @@ namespace PLP {
         }
 
         bool match(const char* str, unsigned int size) override {
-            _substrings.clear();
-
-            char* adjustedStr = const_cast<char*>(str);
-            unsigned int adjustedStrSize = size;
+            const char* line = str;
+            unsigned int lineSize = size;
             if (_trimLine) {
-                stringTrim(str, size, adjustedStr, adjustedStrSize);
-            }
-            std::string sData(adjustedStr, adjustedStrSize);
-
-            size_t pos = 0;
-            unsigned int offset = 0;
-            unsigned int length = 0;
-            while ((pos = sData.find(_splitText, offset)) != std::string::npos) {
-                length = (unsigned int)pos - offset + (unsigned int)_splitText.size();
-                _substrings.emplace_back(sData.data() + offset, length);
-                offset += length;
-            }
-
-            if (offset < sData.size() - 1) {
-                _substrings.emplace_back(sData.data() + offset, (unsigned int)sData.size() - offset);
-            }else if (_substrings.size() == 0) {
-                _substrings.emplace_back(sData.data(), 0);
+                const char* end = str + size;
+                line = findNonSpace(str, end);
+                while (end > line && isSpaceByte(*(end - 1))) {
+                    end--;
+                }
+                lineSize = (unsigned int)(end - line);
             }
 
-            // quick check if one of the comparators is out of bounds
-            for (auto& comparator : _sliceComparators) {
-                if ((comparator.first >= 0 && comparator.first >= _substrings.size()) ||
-                    (comparator.first < 0 && -comparator.first >= _substrings.size())) {
-                    return false;
-                }
+            // also fails if one of the comparators is out of bounds
+            if (!_splitter.split(line, lineSize, _numFirstSlices, _numLastSlices)) {
+                return false;
             }
 
-            int sliceIndex;
             for (auto& comparator : _sliceComparators) {
-                sliceIndex = comparator.first;
-                if (sliceIndex < 0) {
-                    sliceIndex = (int)_substrings.size() + sliceIndex;
-                }
-
-                if (!comparator.second->match(_substrings[sliceIndex].first, _substrings[sliceIndex].second)) {
+                const FieldSplitter::Field& slice = _splitter.getField(comparator.first);
+                if (!comparator.second->match(slice.first, slice.second)) {
                     return false;
                 }
             }
@@ -267,12 +828,50 @@ namespace PLP {
             return match(str.c_str(), (unsigned int)str.length());
         }
 
+        std::shared_ptr<TextComparator> clone() const override {
+            std::unordered_map<int, std::shared_ptr<TextComparator>> clones;
+            if (!cloneAll(_sliceComparators, clones)) {
+                return nullptr;
+            }
+            return std::make_shared<MatchSubstrings>(_splitText, _trimLine, clones);
+        }
+
+        bool isCloneable() const override {
+            return allCloneable(_sliceComparators);
+        }
+
+        double getCost() const override {
+            double cost = 50;
+            for (auto& comparator : _sliceComparators) {
+                cost += comparator.second->getCost();
+            }
+            return cost;
+        }
+
+        void addStatsFrom(const TextComparator& clone) override {
+            const MatchSubstrings* other = dynamic_cast<const MatchSubstrings*>(&clone);
+            if (!other || other->_sliceComparators.size() != _sliceComparators.size()) {
+                return;
+            }
+            for (size_t i = 0; i < _sliceComparators.size(); i++) {
+                _sliceComparators[i].second->addStatsFrom(*other->_sliceComparators[i].second);
+            }
+        }
+
+        void appendStats(std::string& out, unsigned int depth) const override {
+            for (auto& comparator : _sliceComparators) {
+                comparator.second->appendStats(out, depth);
+            }
+        }
+
     private:
         bool _internalFailure = false;
         std::string _splitText;
         bool _trimLine;
         std::vector<std::pair<int, std::shared_ptr<TextComparator>>>  _sliceComparators;
-        std::vector<std::pair<const char*, unsigned int>> _substrings;
+        FieldSplitter _splitter;
+        unsigned int _numFirstSlices = 0;
+        unsigned int _numLastSlices = 0;
     };
 
     class MatchWords : public TextComparator {
@@ -287,11 +886,11 @@ namespace PLP {
                     [](const std::pair<int, std::shared_ptr<TextComparator>>& comp1, const std::pair<int, std::shared_ptr<TextComparator>>& comp2) {
                     return comp1.first < comp2.first;
                 });
-
-                _words.reserve(100);
             } catch (std::bad_alloc&) {
                 _internalFailure = true;
             }
+            getSplitBounds(_wordComparators, _numFirstWords, _numLastWords);
+            _splitter.initializeWords();
         }
 
         bool initialize() override {
@@ -308,24 +907,14 @@ namespace PLP {
         }
 
         bool match(const char* str, unsigned int size) override {
-            splitIntoWords(str, size, _words);
-
-            // quick check if one of the comparators is out of bounds
-            for (auto& comparator : _wordComparators) {
-                if ((comparator.first >= 0 && comparator.first >= _words.size()) ||
-                    (comparator.first < 0 && -comparator.first >= _words.size())) {
-                    return false;
-                }
+            // also fails if one of the comparators is out of bounds
+            if (!_splitter.split(str, size, _numFirstWords, _numLastWords)) {
+                return false;
             }
 
-            int wordIndex;
             for (auto& comparator : _wordComparators) {
-                wordIndex = comparator.first;
-                if (wordIndex < 0) {
-                    wordIndex = (int)_words.size() + wordIndex;
-                }
-
-                if (!comparator.second->match(_words[wordIndex].first, _words[wordIndex].second)) {
+                const FieldSplitter::Field& word = _splitter.getField(comparator.first);
+                if (!comparator.second->match(word.first, word.second)) {
                     return false;
                 }
             }
@@ -337,10 +926,48 @@ namespace PLP {
             return match(str.c_str(), (unsigned int)str.length());
         }
 
+        std::shared_ptr<TextComparator> clone() const override {
+            std::unordered_map<int, std::shared_ptr<TextComparator>> clones;
+            if (!cloneAll(_wordComparators, clones)) {
+                return nullptr;
+            }
+            return std::make_shared<MatchWords>(clones);
+        }
+
+        bool isCloneable() const override {
+            return allCloneable(_wordComparators);
+        }
+
+        double getCost() const override {
+            double cost = 50;
+            for (auto& comparator : _wordComparators) {
+                cost += comparator.second->getCost();
+            }
+            return cost;
+        }
+
+        void addStatsFrom(const TextComparator& clone) override {
+            const MatchWords* other = dynamic_cast<const MatchWords*>(&clone);
+            if (!other || other->_wordComparators.size() != _wordComparators.size()) {
+                return;
+            }
+            for (size_t i = 0; i < _wordComparators.size(); i++) {
+                _wordComparators[i].second->addStatsFrom(*other->_wordComparators[i].second);
+            }
+        }
+
+        void appendStats(std::string& out, unsigned int depth) const override {
+            for (auto& comparator : _wordComparators) {
+                comparator.second->appendStats(out, depth);
+            }
+        }
+
     private:
         bool _internalFailure = false;
         std::vector<std::pair<int, std::shared_ptr<TextComparator>>> _wordComparators;
-        std::vector<std::pair<const char*, unsigned int>> _words;
+        FieldSplitter _splitter;
+        unsigned int _numFirstWords = 0;
+        unsigned int _numLastWords = 0;
     };
 
     class MatchCustom : public TextComparator {
@@ -359,6 +986,18 @@ namespace PLP {
             return _match(str);
         }
 
+        std::shared_ptr<TextComparator> clone() const override {
+            return nullptr; // the custom function may not be safe to call from other threads (Lua state)
+        }
+
+        bool isCloneable() const override {
+            return false;
+        }
+
+        double getCost() const override {
+            return 5000; // calls into Lua
+        }
+
     private:
         std::function<bool(const std::string&)> _match;
     };
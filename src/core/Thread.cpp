@@ -17,69 +17,91 @@
 
 #include "Thread.h"
 
-#include <assert.h>
-
 namespace PLP
 {
-	Thread::Thread(unsigned long long sleepPeriodNs) :
-		_sleepPeriodNs(std::chrono::nanoseconds(sleepPeriodNs)) {
-
-		_running.store(false);
-		_stopped.store(true);
-	}
+    Thread::Thread() {}
 
-	Thread::~Thread() {
-		_running.store(false);			
-        if (_thread.joinable()) {
-            _thread.join();
-        }
-	}
+    Thread::~Thread() {
+        stopAndJoin();
+    }
 
     void Thread::runAsync(std::function<void()> task, TaskStatus& status) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running) { // nothing would run the task, drop it like the ones left behind on stop
+            status.setCompleted(true);
+            return;
+        }
         status.setCompleted(false);
-        _tasks.push(std::make_pair(task, &status));
+        _tasks.push_back(std::make_pair(task, &status));
+        _taskQueued.notify_one();
     }
 
-	bool Thread::start() {
-		_running.store(true);
-        _stopped.store(false);
+    void Thread::wait(TaskStatus& status) {
+        // the status is completed before the notification is sent under the lock, so it can't be missed
+        std::unique_lock<std::mutex> lock(_mutex);
+        _taskCompleted.wait(lock, [&status]() { return status.isCompleted(); });
+    }
 
-        try {
-            _thread = std::thread([&](
-                std::chrono::duration<unsigned long long, std::nano>& sleepPeriod,
-                tbb::concurrent_queue<std::pair<std::function<void()>, TaskStatus*>>* tasks,
-                tbb::atomic<bool>& running,
-                tbb::atomic<bool>& stopped
-                ) {
+    void Thread::dropTasks() {
+        for (auto& task : _tasks) {
+            task.second->setCompleted(true);
+        }
+        _tasks.clear();
+        _taskCompleted.notify_all();
+    }
 
-                while (_running) {
-                    std::this_thread::sleep_for(sleepPeriod);
+    bool Thread::start() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = true;
+        }
 
-                    std::pair<std::function<void()>, TaskStatus*> task;
-                    while (_running && tasks->try_pop(task)) {
-                        task.first();
-                        task.second->setCompleted(true);
+        try {
+            _thread = std::thread([this]() {
+                std::unique_lock<std::mutex> lock(_mutex);
+                while (true) {
+                    _taskQueued.wait(lock, [this]() { return !_running || !_tasks.empty(); });
+                    if (!_running) {
+                        return;
                     }
+
+                    std::pair<std::function<void()>, TaskStatus*> task = std::move(_tasks.front());
+                    _tasks.pop_front();
+                    lock.unlock();
+
+                    task.first();
+                    task.second->setCompleted(true);
+
+                    lock.lock();
+                    _taskCompleted.notify_all();
                 }
-                stopped.store(true);
-            }, std::ref(_sleepPeriodNs), &_tasks, std::ref(_running), std::ref(_stopped));
+            });
         } catch (std::system_error&) {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
             return false;
         }
 
         return true;
-	}
+    }
 
-	void Thread::stop() {
-		_running.store(false);
-	}
+    void Thread::stop() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _running = false;
+        // tasks left in the queue are dropped, their owners must not wait on them forever
+        dropTasks();
+        _taskQueued.notify_all();
+    }
 
-	void Thread::stopAndJoin() {
-		_running.store(false);
-		while (!_stopped) {}
-	}
+    void Thread::stopAndJoin() {
+        stop();
+        if (_thread.joinable()) {
+            _thread.join();
+        }
+    }
 
-	bool Thread::isRunning() {
-		return _running.load();
-	}
-}
\ No newline at end of file
+    bool Thread::isRunning() {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _running;
+    }
+}
@@ -19,32 +19,38 @@
 
 #include "TaskRunner.h"
 
-#include "tbb\atomic.h"
-#include "tbb\concurrent_queue.h"
 #include <thread>
 #include <functional>
-#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
 
 namespace PLP
 {
-	class Thread : public TaskRunner
-	{
-	public:
-		Thread(unsigned long long sleepPeriodNs);
-		~Thread();
+    // Runs tasks one after another on a single thread, which blocks while the queue is empty. Tasks that are still
+    // queued when the thread stops, or that are queued after it stopped, are marked as completed without running
+    class Thread : public TaskRunner
+    {
+    public:
+        Thread();
+        ~Thread();
 
-		void runAsync(std::function<void()> task, TaskStatus& status);
-		bool start();
-		void stop();
-		void stopAndJoin();
-		bool isRunning();
+        void runAsync(std::function<void()> task, TaskStatus& status) override;
+        void wait(TaskStatus& status) override;
+        bool start();
+        void stop();
+        void stopAndJoin();
+        bool isRunning();
+
+    private:
+        // marks queued tasks as completed without running them
+        void dropTasks();
 
-	private:
         std::thread _thread;
-        tbb::concurrent_queue<std::pair<std::function<void()>, TaskStatus*>> _tasks;
-		std::chrono::duration<unsigned long long, std::nano> _sleepPeriodNs;
-			
-		tbb::atomic<bool> _running;
-		tbb::atomic<bool> _stopped;
-	};
+        std::deque<std::pair<std::function<void()>, TaskStatus*>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _taskQueued;
+        std::condition_variable _taskCompleted;
+        bool _running = false;
+    };
 }
@@ -0,0 +1,120 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "ThreadPool.h"
+
+#include <chrono>
+
+namespace PLP {
+    ThreadPool::ThreadPool(unsigned int numThreads) : _numThreads(numThreads > 0 ? numThreads : 1) {}
+
+    ThreadPool::~ThreadPool() {
+        stopAndJoin();
+    }
+
+    void ThreadPool::runAsync(std::function<void()> task, TaskStatus& status) {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (!_running) { // nothing would run the task
+            status.setCompleted(true);
+            return;
+        }
+        status.setCompleted(false);
+        _tasks.push_back(std::make_pair(task, &status));
+        _taskQueued.notify_one();
+    }
+
+    bool ThreadPool::start() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = true;
+        }
+
+        try {
+            for (unsigned int i = 0; i < _numThreads; i++) {
+                _threads.emplace_back([this]() {
+                    std::unique_lock<std::mutex> lock(_mutex);
+                    while (true) {
+                        _taskQueued.wait(lock, [this]() { return !_running || !_tasks.empty(); });
+                        if (!_running) {
+                            return;
+                        }
+
+                        std::pair<std::function<void()>, TaskStatus*> task = std::move(_tasks.front());
+                        _tasks.pop_front();
+                        lock.unlock();
+
+                        task.first();
+                        task.second->setCompleted(true);
+
+                        // the waiter checks the status under the lock, so the notification can't fall between its check and its wait
+                        lock.lock();
+                        _taskCompleted.notify_all();
+                    }
+                });
+            }
+        } catch (std::system_error&) {
+            stopAndJoin();
+            return false;
+        }
+
+        return true;
+    }
+
+    void ThreadPool::stopAndJoin() {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _running = false;
+            dropTasks();
+            _taskQueued.notify_all();
+            _taskCompleted.notify_all();
+        }
+        for (auto& thread : _threads) {
+            if (thread.joinable()) {
+                thread.join();
+            }
+        }
+        _threads.clear();
+    }
+
+    unsigned int ThreadPool::getNumThreads() const {
+        return _numThreads;
+    }
+
+    void ThreadPool::wait(TaskStatus& status) {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _taskCompleted.wait(lock, [&status]() { return status.isCompleted(); });
+    }
+
+    bool ThreadPool::wait(TaskStatus& status, const std::atomic<bool>& cancelled) {
+        // cancellation is not signalled, so it is checked periodically
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (!status.isCompleted()) {
+            if (cancelled) {
+                return false;
+            }
+            _taskCompleted.wait_for(lock, std::chrono::milliseconds(CANCEL_CHECK_PERIOD_MS));
+        }
+        return true;
+    }
+
+    void ThreadPool::dropTasks() {
+        for (auto& task : _tasks) {
+            task.second->setCompleted(true);
+        }
+        _tasks.clear();
+    }
+}
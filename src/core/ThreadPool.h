@@ -0,0 +1,61 @@
+/*
+ * This file is part of the Line Catcher distribution (https://github.com/AlexandrSachkov/LineCatcher).
+ * Copyright (c) 2019 Alexandr Sachkov.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, version 3.
+ *
+ * This program is distributed in the hope that it will be useful, but
+ * WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+ * General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "TaskRunner.h"
+
+#include <thread>
+#include <functional>
+#include <mutex>
+#include <condition_variable>
+#include <atomic>
+#include <deque>
+#include <vector>
+
+namespace PLP {
+    // Runs tasks on a fixed number of threads sharing one queue. Idle threads block until a task is queued.
+    // Tasks that are still queued when the pool stops, or that are queued after it stopped, are marked as
+    // completed without running
+    class ThreadPool : public TaskRunner {
+    public:
+        ThreadPool(unsigned int numThreads);
+        ~ThreadPool();
+
+        void runAsync(std::function<void()> task, TaskStatus& status) override;
+        bool start();
+        void stopAndJoin();
+        unsigned int getNumThreads() const;
+
+        void wait(TaskStatus& status) override;
+        // Blocks until the task of the given status is completed. Returns false if cancelled was set first
+        bool wait(TaskStatus& status, const std::atomic<bool>& cancelled);
+
+    private:
+        static const unsigned long long CANCEL_CHECK_PERIOD_MS = 10;
+
+        void dropTasks();
+
+        unsigned int _numThreads = 0;
+        std::vector<std::thread> _threads;
+        std::deque<std::pair<std::function<void()>, TaskStatus*>> _tasks;
+        std::mutex _mutex;
+        std::condition_variable _taskQueued;
+        std::condition_variable _taskCompleted;
+        bool _running = false;
+    };
+}
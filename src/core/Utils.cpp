@@ -16,6 +16,7 @@
  */
 
 #include "Utils.h"
+#include "ByteSearch.h"
 
 namespace PLP {
     const char* findLastLineEnding(const char* buff, unsigned long long buffSize, const char* currPos) {
@@ -47,23 +48,18 @@ namespace PLP {
             return LineReaderResult::ERROR;
         }
 
-        char* pos = const_cast<char*>(buff) + startOffsetBytes;
-        while ((buff - pos  + 1) < maxLineSize 
-            && pos < buff + buffSize 
-            && *pos != '\n'
-            ) {
-            pos++;
-        }
-
-        if (buff - pos + 1 >= maxLineSize) {
-            return LineReaderResult::ERROR;
-        }
+        // a line ending has to be found within maxLineSize bytes, unless the buffer ends first
+        const char* start = buff + startOffsetBytes;
+        const char* end = buff + buffSize;
+        const bool limitedByMaxLineSize = (unsigned long long)(end - start) > maxLineSize;
+        const char* searchEnd = limitedByMaxLineSize ? start + maxLineSize : end;
 
-        if (pos == buff + buffSize) {
-            return LineReaderResult::NOT_FOUND;
+        const char* pos = findByte(start, searchEnd, '\n');
+        if (pos == searchEnd) {
+            return limitedByMaxLineSize ? LineReaderResult::ERROR : LineReaderResult::NOT_FOUND;
         }
 
-        lineEnding = pos;
+        lineEnding = const_cast<char*>(pos);
         return LineReaderResult::SUCCESS;
     }
 }
\ No newline at end of file
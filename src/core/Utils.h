@@ -145,7 +145,7 @@ namespace PLP {
     //https://docs.microsoft.com/en-us/previous-versions/windows/it-pro/windows-2000-server/cc938632(v=technet.10)
     const unsigned long long OPTIMAL_BLOCK_SIZE_BYTES = 64 * 1024; //64 KBytes 
 
-    static const unsigned int RESULT_SET_VERSION = 1; // increment if format changes
+    static const unsigned int RESULT_SET_VERSION = 2; // increment if format changes, see IndexFormat.h
 
     static const char* FILE_RANDOM_ACCESS_INDEX_EXTENSION = ".lcfraidx";
     static const char* FILE_INDEX_EXTENSION = ".lcidx";
@@ -152,29 +152,16 @@ void IndexViewWidget::readNextBlock() {
     const int currScrollbarValue = this->verticalScrollBar()->value();
     const unsigned long long currStartLineNum = _startLineNum;
 
-    unsigned long long lineNum;
     QString line;
-
     QTextCursor cursor = this->textCursor();
-    if(_indexReader->getResult(_endLineNum, lineNum)){
-        if(!_fileViewer->getLineFromIndex(_indexReader, line)){
-            return;
+    const unsigned long long numResults = readResults(_endLineNum, NUM_LINES_PER_READ + 1);
+    for(unsigned long long i = 0; i < numResults; i++){
+        if(!_fileViewer->getLineFromResult(_results[i], line)){
+            break;
         }
         cursor.movePosition(QTextCursor::End);
-        cursor.insertText(QString::number(lineNum) + ":   " + line);
+        cursor.insertText(QString::number(_results[i].lineNum) + ":   " + line);
         _endLineNum++;
-
-        for(unsigned int i = 0; i < NUM_LINES_PER_READ; i++){
-            if(!_indexReader->nextResult(lineNum)){
-                break;
-            }
-            if(!_fileViewer->getLineFromIndex(_indexReader, line)){
-                break;
-            }
-            cursor.movePosition(QTextCursor::End);
-            cursor.insertText(QString::number(lineNum) + ":   " + line);
-            _endLineNum++;
-        }
     }
 
     if(_endLineNum - _startLineNum > MAX_NUM_BLOCKS){
@@ -204,8 +191,6 @@ void IndexViewWidget::readPreviousBlock() {
         numLinesToDelete = totalFutureNumLines - MAX_NUM_BLOCKS;
     }
 
-    unsigned long long lineNum;
-
     //delete lines from end of document
     QTextCursor cursor = this->textCursor();
     cursor.movePosition(QTextCursor::End);
@@ -225,21 +210,12 @@ void IndexViewWidget::readPreviousBlock() {
     //insert new lines
     QString line;
     cursor.movePosition(QTextCursor::Start);
-    if(_indexReader->getResult(_startLineNum, lineNum)){
-        if(!_fileViewer->getLineFromIndex(_indexReader, line)){
+    const unsigned long long numResults = readResults(_startLineNum, numLinesToRead);
+    for(unsigned long long i = 0; i < numResults; i++){
+        if(!_fileViewer->getLineFromResult(_results[i], line)){
             return;
         }
-        cursor.insertText(QString::number(lineNum) + ":   " + line);
-
-        for(unsigned int i = 0; i < numLinesToRead - 1; i++){
-            if(!_indexReader->nextResult(lineNum)){
-                break;
-            }
-            if(!_fileViewer->getLineFromIndex(_indexReader, line)){
-                return;
-            }
-            cursor.insertText(QString::number(lineNum) + ":   " + line);
-        }
+        cursor.insertText(QString::number(_results[i].lineNum) + ":   " + line);
     }
 
     //insert last empty block
@@ -250,6 +226,18 @@ void IndexViewWidget::readPreviousBlock() {
     this->verticalScrollBar()->setValue(newScrollbarValue);
 }
 
+// reads num results starting at result number first in one batch
+unsigned long long IndexViewWidget::readResults(unsigned long long first, unsigned long long num) {
+    _results.resize(num);
+
+    unsigned long long lineNum;
+    if(num == 0 || !_indexReader->getResult(first, lineNum)){
+        return 0;
+    }
+    _results[0] = {lineNum, _indexReader->getLineFileOffset()};
+    return 1 + _indexReader->nextResults(_results.data() + 1, num - 1);
+}
+
 void IndexViewWidget::readBlockIfRequired() {
     const int currScrollbarValue = this->verticalScrollBar()->value();
     const unsigned long long currStartLineNum = _startLineNum;
@@ -301,29 +289,17 @@ void IndexViewWidget::gotoLine(unsigned long long lineNum){
 
     this->clear();
 
-    unsigned long long resLineNum;
     QString line;
     QTextCursor cursor = this->textCursor();
-    if(_indexReader->getResult(_startLineNum, resLineNum)){
-        if(!_fileViewer->getLineFromIndex(_indexReader, line)){
+    const unsigned long long numResults = readResults(_startLineNum, NUM_LINES_PER_READ);
+    for(unsigned long long i = 0; i < numResults; i++){
+        if(!_fileViewer->getLineFromResult(_results[i], line)){
             return;
         }
+
         cursor.movePosition(QTextCursor::End);
-        cursor.insertText(QString::number(resLineNum) + ":   " + line);
+        cursor.insertText(QString::number(_results[i].lineNum) + ":   " + line);
         _endLineNum++;
-
-        for(unsigned int i = 0; i < NUM_LINES_PER_READ - 1; i++){
-            if(!_indexReader->nextResult(resLineNum)){
-                break;
-            }
-            if(!_fileViewer->getLineFromIndex(_indexReader, line)){
-                return;
-            }
-
-            cursor.movePosition(QTextCursor::End);
-            cursor.insertText(QString::number(resLineNum) + ":   " + line);
-            _endLineNum++;
-        }
     }
 
     if(_endLineNum - _startLineNum > MAX_NUM_BLOCKS){
@@ -60,6 +60,7 @@ private:
     void calcNumVisibleLines();
     void readNextBlock();
     void readPreviousBlock();
+    unsigned long long readResults(unsigned long long first, unsigned long long num);
     void mouseReleaseEvent(QMouseEvent* event) override;
 
     static const unsigned int MAX_NUM_BLOCKS = 1000;
@@ -71,6 +72,7 @@ private:
     ULLSpinBox* _lineNavBox;
     std::vector<unsigned long long> _indices;
     std::vector<QString> _data;
+    std::vector<PLP::IndexResult> _results;
 
     unsigned long long _startLineNum = 0;
     unsigned long long _endLineNum = 0;
@@ -308,6 +308,20 @@ bool PagedFileViewWidget::getLineFromIndex(
     return true;
 }
 
+bool PagedFileViewWidget::getLineFromResult(
+        const PLP::IndexResult& result,
+        QString& data
+) {
+    char* lineStart = nullptr;
+    unsigned int length;
+    if(PLP::LineReaderResult::SUCCESS != _fileReader->getLineAtOffset(result.lineNum, result.fileOffset, lineStart, length)){
+        return false;
+    }
+
+    data = QString::fromUtf8(lineStart, length).replace("\r","");
+    return true;
+}
+
 void PagedFileViewWidget::gotoLine(unsigned long long lineNum, bool highlight){
     if(lineNum >= _startLineNum && lineNum < _endLineNum){
         this->verticalScrollBar()->setValue(lineNum - _startLineNum);
@@ -53,6 +53,10 @@ public:
         CoreObjPtr<PLP::IndexReaderI>& indexReader,
         QString& data
     );
+    bool getLineFromResult(
+        const PLP::IndexResult& result,
+        QString& data
+    );
 
     void setFontSize(int pointSize);
     void onHighlightListUpdated();
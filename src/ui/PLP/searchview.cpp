@@ -182,6 +182,10 @@ void SearchView::createSearchOptionContent(QLayout* mainLayout) {
     _regex->setMaximumWidth(75);
     checkboxLayout->addWidget(_regex);
 
+    _ignoreCase = new QCheckBox("Ignore case", this);
+    _ignoreCase->setMaximumWidth(100);
+    checkboxLayout->addWidget(_ignoreCase);
+
     _highlightResults = new QCheckBox("Highlight results", this);
     checkboxLayout->addWidget(_highlightResults);
 }
@@ -241,6 +245,15 @@ void SearchView::createMultilineSearchOptionContent(QLayout* mainLayout){
             formLayout->addWidget(regexCheckBox, i + 1, 3);
         }
     }
+
+    //Ignore case
+    {
+        for(int i = 0; i < NUM_ROWS; i++){
+            QCheckBox* ignoreCaseCheckBox = new QCheckBox("Ignore case", this);
+            _ignoreCaseCheckBoxes.push_back(ignoreCaseCheckBox);
+            formLayout->addWidget(ignoreCaseCheckBox, i + 1, 4);
+        }
+    }
 }
 
 void SearchView::startSearch() {
@@ -377,12 +390,13 @@ void SearchView::startRegularSearch(
     }
 
     bool regex = _regex->isChecked();
+    bool ignoreCase = _ignoreCase->isChecked();
 
     std::unique_ptr<PLP::TextComparator> comparator = nullptr;
     if(regex){
-        comparator.reset(new PLP::MatchRegex(searchPattern.toStdString()));
+        comparator.reset(new PLP::MatchRegex(searchPattern.toStdString(), ignoreCase));
     }else{
-        comparator.reset(new PLP::MatchString(searchPattern.toStdString(), false));
+        comparator.reset(new PLP::MatchString(searchPattern.toStdString(), false, ignoreCase));
     }
 
     if(!comparator || !comparator->initialize()){
@@ -455,13 +469,15 @@ void SearchView::startMultilineSearch(
 
             if(_regexCheckBoxes[i]->isChecked()){
                 std::shared_ptr<PLP::TextComparator> comparator(new PLP::MatchRegex(
-                    _searchPatternBoxes[i]->text().toStdString()
+                    _searchPatternBoxes[i]->text().toStdString(),
+                    _ignoreCaseCheckBoxes[i]->isChecked()
                 ));
                 lineComparators.emplace(_lineOffsetBoxes[i]->value(), comparator);
             }else{
                 std::shared_ptr<PLP::TextComparator> comparator(new PLP::MatchString(
                     _searchPatternBoxes[i]->text().toStdString(),
-                    false
+                    false,
+                    _ignoreCaseCheckBoxes[i]->isChecked()
                 ));
                 lineComparators.emplace(_lineOffsetBoxes[i]->value(), comparator);
             }
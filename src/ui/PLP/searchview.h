@@ -86,12 +86,14 @@ private:
     ULLSpinBox* _numResultsBox = nullptr;
     QLineEdit* _searchField = nullptr;
     QCheckBox* _regex = nullptr;
+    QCheckBox* _ignoreCase = nullptr;
     QCheckBox* _highlightResults = nullptr;
 
     std::vector<QCheckBox*> _lineEnabledCheckBoxes;
     std::vector<QSpinBox*> _lineOffsetBoxes;
     std::vector<QLineEdit*> _searchPatternBoxes;
     std::vector<QCheckBox*> _regexCheckBoxes;
+    std::vector<QCheckBox*> _ignoreCaseCheckBoxes;
 };
 
 #endif // STANDARDSEARCHVIEW_H